@@ -0,0 +1,350 @@
+#include "ChannelLanes.h"
+
+//==============================================================================
+namespace
+{
+    // Coefficient sources for ChannelLanes::processRegisters, which asks for
+    // each coefficient by register of channels and advances them once per
+    // sample. SharedCoefficients gives every lane the same value.
+    template <typename Lanes>
+    struct SharedCoefficients
+    {
+        SmooshSettings settings;
+        const SmooshSettings& increment;
+
+        Lanes lpCoeff (int) const noexcept              { return Lanes::expand (settings.lpCoeff); }
+        Lanes hpCoeff (int) const noexcept              { return Lanes::expand (settings.hpCoeff); }
+        Lanes attackCoeff (int) const noexcept          { return Lanes::expand (settings.attackCoeff); }
+        Lanes releaseCoeff (int) const noexcept         { return Lanes::expand (settings.releaseCoeff); }
+        Lanes sibilanceSensitivity (int) const noexcept { return Lanes::expand (settings.sibilanceSensitivity); }
+
+        template <int registers>
+        void advance() noexcept { settings.advance (increment); }
+    };
+
+    template <typename Lanes, typename Coefficients>
+    struct PerLaneCoefficients
+    {
+        Coefficients coefficients;
+        const Coefficients& increment;
+
+        Lanes lpCoeff (int r) const noexcept              { return coefficients.lpCoeff[(size_t) r]; }
+        Lanes hpCoeff (int r) const noexcept              { return coefficients.hpCoeff[(size_t) r]; }
+        Lanes attackCoeff (int r) const noexcept          { return coefficients.attackCoeff[(size_t) r]; }
+        Lanes releaseCoeff (int r) const noexcept         { return coefficients.releaseCoeff[(size_t) r]; }
+        Lanes sibilanceSensitivity (int r) const noexcept { return coefficients.sibilanceSensitivity[(size_t) r]; }
+
+        template <int registers>
+        void advance() noexcept
+        {
+            for (size_t r = 0; r < (size_t) registers; ++r)
+            {
+                coefficients.lpCoeff[r] += increment.lpCoeff[r];
+                coefficients.hpCoeff[r] += increment.hpCoeff[r];
+                coefficients.attackCoeff[r] += increment.attackCoeff[r];
+                coefficients.releaseCoeff[r] += increment.releaseCoeff[r];
+                coefficients.sibilanceSensitivity[r] += increment.sibilanceSensitivity[r];
+            }
+        }
+    };
+}
+
+//==============================================================================
+template <typename SampleType>
+int ChannelLanes<SampleType>::getRegistersFor (int numChannels) noexcept
+{
+    int registers = 1;
+
+    while (registers < maxRegisters && registers * laneWidth < numChannels)
+        registers *= 2;
+
+    return registers;
+}
+
+template <typename SampleType>
+ChannelLanes<SampleType>::ChannelLanes (int registers) noexcept
+    : numRegisters (registers)
+{
+    jassert (registers == 1 || registers == 2 || registers == 4);
+}
+
+//==============================================================================
+template <typename SampleType>
+void ChannelLanes<SampleType>::process (Lanes* frames, Lanes* envelopeFrames, int numSamples,
+                                        SmooshSettings settings, const SmooshSettings& increment,
+                                        KeySource source) noexcept
+{
+    processFrom<true> (source, frames, envelopeFrames, numSamples, settings, increment);
+}
+
+template <typename SampleType>
+void ChannelLanes<SampleType>::processDetector (Lanes* frames, Lanes* levelFrames, int numSamples,
+                                                SmooshSettings settings, const SmooshSettings& increment,
+                                                KeySource source) noexcept
+{
+    processFrom<false> (source, frames, levelFrames, numSamples, settings, increment);
+}
+
+template <typename SampleType>
+void ChannelLanes<SampleType>::processLanes (Lanes* frames, Lanes* envelopeFrames, int numSamples,
+                                             const LaneCoefficients& coefficients, const LaneCoefficients& increment) noexcept
+{
+    const PerLaneCoefficients<Lanes, LaneCoefficients> perLane { coefficients, increment };
+    processGroup<true, KeySource::internal> (frames, envelopeFrames, numSamples, perLane);
+}
+
+template <typename SampleType>
+template <bool followEnvelope>
+void ChannelLanes<SampleType>::processFrom (KeySource source, Lanes* frames, Lanes* envelopeFrames, int numSamples,
+                                            const SmooshSettings& settings, const SmooshSettings& increment) noexcept
+{
+    const SharedCoefficients<Lanes> shared { settings, increment };
+
+    switch (source)
+    {
+        case KeySource::internal:        processGroup<followEnvelope, KeySource::internal> (frames, envelopeFrames, numSamples, shared); break;
+        case KeySource::sidechain:       processGroup<followEnvelope, KeySource::sidechain> (frames, envelopeFrames, numSamples, shared); break;
+        case KeySource::sidechainDirect: processGroup<followEnvelope, KeySource::sidechainDirect> (frames, envelopeFrames, numSamples, shared); break;
+    }
+}
+
+template <typename SampleType>
+template <bool followEnvelope, KeySource source, typename Coefficients>
+void ChannelLanes<SampleType>::processGroup (Lanes* frames, Lanes* envelopeFrames, int numSamples,
+                                             const Coefficients& coefficients) noexcept
+{
+    switch (numRegisters)
+    {
+        case 1:  processRegisters<1, followEnvelope, source> (frames, envelopeFrames, numSamples, coefficients); break;
+        case 2:  processRegisters<2, followEnvelope, source> (frames, envelopeFrames, numSamples, coefficients); break;
+        default: processRegisters<4, followEnvelope, source> (frames, envelopeFrames, numSamples, coefficients); break;
+    }
+}
+
+template <typename SampleType>
+template <int registers, bool followEnvelope, KeySource source, typename Coefficients>
+void ChannelLanes<SampleType>::processRegisters (Lanes* frames, Lanes* envelopeFrames, int numSamples,
+                                                 Coefficients coefficients) noexcept
+{
+    // Work on local copies so the state stays in registers for the whole block
+    Lanes lp[registers], hp1[registers], hp2[registers], env[registers];
+
+    for (int r = 0; r < registers; ++r)
+    {
+        lp[r] = lpState[(size_t) r];
+        hp1[r] = hpState1[(size_t) r];
+        hp2[r] = hpState2[(size_t) r];
+        env[r] = envelope[(size_t) r];
+    }
+
+    const auto zero = Lanes::expand (SampleType (0));
+    const auto one = Lanes::expand (SampleType (1));
+
+    for (int sample = 0; sample < numSamples; ++sample)
+    {
+        // The registers are independent recursions, so the CPU overlaps them
+        for (int r = 0; r < registers; ++r)
+        {
+            const auto lpCoeff = coefficients.lpCoeff (r);
+            const auto hpCoeff = coefficients.hpCoeff (r);
+            const auto release = coefficients.releaseCoeff (r);
+            const auto attackMinusRelease = coefficients.attackCoeff (r) - release;
+
+            auto& frame = frames[sample * registers + r];
+
+            // Low-pass filter to reduce high-frequency harshness
+            lp[r] = frame * (one - lpCoeff) + lp[r] * lpCoeff;
+            frame = lp[r];
+
+            Lanes inputLevel;
+
+            if constexpr (source == KeySource::sidechainDirect)
+            {
+                // The key as is, instead of the sibilance detection
+                const auto key = envelopeFrames[sample * registers + r];
+                inputLevel = Lanes::max (key, zero - key);
+            }
+            else
+            {
+                const auto detectorInput = source == KeySource::internal ? lp[r] : envelopeFrames[sample * registers + r];
+
+                // High-pass filter for sibilance detection (simple one-pole)
+                const auto hpSample = detectorInput - hp1[r];
+                hp1[r] = detectorInput * (one - hpCoeff) + hp1[r] * hpCoeff;
+
+                // Second stage for steeper roll-off
+                const auto hpSample2 = hpSample - hp2[r];
+                hp2[r] = hpSample * (one - hpCoeff) + hp2[r] * hpCoeff;
+
+                // Blend between full-spectrum and high-passed for sidechain detection
+                const auto detectionSample = detectorInput + (hpSample2 - detectorInput) * coefficients.sibilanceSensitivity (r);
+                inputLevel = Lanes::max (detectionSample, zero - detectionSample);
+            }
+
+            if constexpr (followEnvelope)
+            {
+                // Envelope follower (peak detection): pick the attack coefficient in
+                // the lanes that are rising, release in the others
+                const auto rising = Lanes::greaterThan (inputLevel, env[r]);
+                const auto coeff = release + (attackMinusRelease & rising);
+
+                env[r] = coeff * env[r] + (one - coeff) * inputLevel;
+                envelopeFrames[sample * registers + r] = env[r];
+            }
+            else
+            {
+                envelopeFrames[sample * registers + r] = inputLevel;
+            }
+        }
+
+        coefficients.template advance<registers>();
+    }
+
+    for (int r = 0; r < registers; ++r)
+    {
+        lpState[(size_t) r] = lp[r];
+        hpState1[(size_t) r] = hp1[r];
+        hpState2[(size_t) r] = hp2[r];
+        envelope[(size_t) r] = env[r];
+    }
+}
+
+template <typename SampleType>
+void ChannelLanes<SampleType>::processLowPass (Lanes* frames, int numSamples, SmooshSettings settings,
+                                               const SmooshSettings& increment) noexcept
+{
+    switch (numRegisters)
+    {
+        case 1:  processLowPassRegisters<1> (frames, numSamples, settings, increment); break;
+        case 2:  processLowPassRegisters<2> (frames, numSamples, settings, increment); break;
+        default: processLowPassRegisters<4> (frames, numSamples, settings, increment); break;
+    }
+}
+
+template <typename SampleType>
+template <int registers>
+void ChannelLanes<SampleType>::processLowPassRegisters (Lanes* frames, int numSamples, SmooshSettings settings,
+                                                        const SmooshSettings& increment) noexcept
+{
+    // The same recursion as in processRegisters, so the output matches it exactly
+    Lanes lp[registers];
+
+    for (int r = 0; r < registers; ++r)
+        lp[r] = lpState[(size_t) r];
+
+    const auto one = Lanes::expand (SampleType (1));
+
+    for (int sample = 0; sample < numSamples; ++sample)
+    {
+        const auto lpCoeff = Lanes::expand (settings.lpCoeff);
+
+        for (int r = 0; r < registers; ++r)
+        {
+            auto& frame = frames[sample * registers + r];
+            lp[r] = frame * (one - lpCoeff) + lp[r] * lpCoeff;
+            frame = lp[r];
+        }
+
+        settings.advance (increment);
+    }
+
+    for (int r = 0; r < registers; ++r)
+        lpState[(size_t) r] = lp[r];
+}
+
+template <typename SampleType>
+void ChannelLanes<SampleType>::applyControlGain (Lanes* frames, const Lanes* gainFrames, int numSamples, int rate) const noexcept
+{
+    jassert (rate > 0);
+
+    switch (numRegisters)
+    {
+        case 1:  applyControlGainRegisters<1> (frames, gainFrames, numSamples, rate); break;
+        case 2:  applyControlGainRegisters<2> (frames, gainFrames, numSamples, rate); break;
+        default: applyControlGainRegisters<4> (frames, gainFrames, numSamples, rate); break;
+    }
+}
+
+template <typename SampleType>
+template <int registers>
+void ChannelLanes<SampleType>::applyControlGainRegisters (Lanes* frames, const Lanes* gainFrames, int numSamples, int rate) noexcept
+{
+    // A straight line per period, from the gain at its start to the gain at
+    // its end, which the last sample of the period gets exactly
+    for (int periodStart = 0, point = 0; periodStart < numSamples; periodStart += rate, ++point)
+    {
+        const int length = juce::jmin (rate, numSamples - periodStart);
+        const auto step = Lanes::expand (SampleType (1) / static_cast<SampleType> (length));
+        Lanes gain[registers], slope[registers];
+
+        for (int r = 0; r < registers; ++r)
+        {
+            gain[r] = gainFrames[point * registers + r];
+            slope[r] = (gainFrames[(point + 1) * registers + r] - gain[r]) * step;
+        }
+
+        for (int sample = periodStart; sample < periodStart + length; ++sample)
+        {
+            for (int r = 0; r < registers; ++r)
+            {
+                gain[r] += slope[r];
+                frames[sample * registers + r] *= gain[r];
+            }
+        }
+    }
+}
+
+//==============================================================================
+template <typename SampleType>
+bool ChannelLanes<SampleType>::isSilent (SampleType threshold) const noexcept
+{
+    auto peak = Lanes::expand (SampleType (0));
+
+    for (int r = 0; r < numRegisters; ++r)
+        for (auto state : { lpState[(size_t) r], hpState1[(size_t) r], hpState2[(size_t) r], envelope[(size_t) r] })
+            peak = Lanes::max (peak, Lanes::max (state, Lanes::expand (SampleType (0)) - state));
+
+    for (size_t lane = 0; lane < Lanes::SIMDNumElements; ++lane)
+        if (peak.get (lane) > threshold)
+            return false;
+
+    return true;
+}
+
+template <typename SampleType>
+SampleType ChannelLanes<SampleType>::getMaxEnvelope() const noexcept
+{
+    SampleType maxEnvelope = 0;
+
+    for (int r = 0; r < numRegisters; ++r)
+        for (size_t lane = 0; lane < Lanes::SIMDNumElements; ++lane)
+            maxEnvelope = juce::jmax (maxEnvelope, envelope[(size_t) r].get (lane));
+
+    return maxEnvelope;
+}
+
+template <typename SampleType>
+void ChannelLanes<SampleType>::setEnvelope (SampleType value) noexcept
+{
+    for (int r = 0; r < numRegisters; ++r)
+        envelope[(size_t) r] = Lanes::expand (value);
+}
+
+template <typename SampleType>
+void ChannelLanes<SampleType>::reset() noexcept
+{
+    *this = ChannelLanes (numRegisters);
+}
+
+template <typename SampleType>
+void ChannelLanes<SampleType>::resetLanes (int firstLane, int numLanes) noexcept
+{
+    jassert (firstLane >= 0 && firstLane + numLanes <= getWidth());
+
+    for (auto* state : { &lpState, &hpState1, &hpState2, &envelope })
+        std::fill_n (reinterpret_cast<SampleType*> (state->data()) + firstLane, numLanes, SampleType (0));
+}
+
+//==============================================================================
+template struct ChannelLanes<float>;
+template struct ChannelLanes<double>;
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include "SmooshCurve.h"
+
+//==============================================================================
+// What the detector listens to: the channel's own low-passed signal, or an
+// external key (sidechain) either through the same high-pass blend or
+// rectified as is, replacing the sibilance detection.
+enum class KeySource
+{
+    internal,
+    sidechain,
+    sidechainDirect
+};
+
+//==============================================================================
+// Recursive filter and envelope state for a group of channels.
+//
+// The low-pass, the two-stage sibilance high-pass and the envelope follower
+// can't vectorize across time, so they run across channels instead. The state
+// is a structure of arrays: every state variable is numRegisters
+// juce::dsp::SIMDRegisters holding that variable for getWidth() channels (one
+// channel per lane), and the group steps through frames of interleaved
+// samples. Mono and stereo use a single register; surround and discrete
+// layouts use groups of up to maxRegisters registers (16 float or 8 double
+// channels with SSE or NEON), whose independent recursions also overlap in
+// the pipeline.
+//
+// SampleType is float or double, matching the processor's precision; the
+// coefficients stay float either way.
+template <typename SampleType>
+struct ChannelLanes
+{
+    using Lanes = juce::dsp::SIMDRegister<SampleType>;
+    static constexpr int laneWidth = static_cast<int> (Lanes::SIMDNumElements);
+    static constexpr int maxRegisters = 4;
+
+    // The fewest registers (1, 2 or 4) holding numChannels, capped at
+    // maxRegisters; wider layouts are split into several groups
+    static int getRegistersFor (int numChannels) noexcept;
+
+    explicit ChannelLanes (int registers = 1) noexcept;
+
+    int numRegisters = 1;
+
+    std::array<Lanes, maxRegisters> lpState {};
+    std::array<Lanes, maxRegisters> hpState1 {};
+    std::array<Lanes, maxRegisters> hpState2 {};
+    std::array<Lanes, maxRegisters> envelope {};
+
+    // Channels per group, i.e. floats per frame
+    int getWidth() const noexcept { return numRegisters * laneWidth; }
+
+    // Low-pass (in place on `frames`), sibilance detection and envelope follower
+    // (written to `envelopeFrames`) for numSamples frames of numRegisters
+    // registers each. Coefficients start at `settings` and advance by
+    // `increment` every sample. With a sidechain key source, `envelopeFrames`
+    // holds the interleaved key on the way in, and each frame is read before
+    // its envelope overwrites it.
+    void process (Lanes* frames, Lanes* envelopeFrames, int numSamples,
+                  SmooshSettings settings, const SmooshSettings& increment,
+                  KeySource source = KeySource::internal) noexcept;
+
+    // Same low-pass and sibilance detection, but writes the rectified detector
+    // level to `levelFrames` and leaves the envelope alone, for linked mode
+    // where one envelope follower serves every channel
+    void processDetector (Lanes* frames, Lanes* levelFrames, int numSamples,
+                          SmooshSettings settings, const SmooshSettings& increment,
+                          KeySource source = KeySource::internal) noexcept;
+
+    // Only the low-pass, for the second pass of two-pass rendering, where a
+    // precomputed gain curve replaces the detector. The detector state is left
+    // alone.
+    void processLowPass (Lanes* frames, int numSamples, SmooshSettings settings, const SmooshSettings& increment) noexcept;
+
+    // Control-rate gain: multiplies numSamples frames by gains given only at
+    // the start of the block and at the end of every period of `rate` samples
+    // (the last period may be shorter), ceil (numSamples / rate) + 1 frames of
+    // numRegisters registers, interpolated linearly in between
+    void applyControlGain (Lanes* frames, const Lanes* gainFrames, int numSamples, int rate) const noexcept;
+
+    // Coefficients that differ from lane to lane, for groups whose lanes
+    // belong to different streams (see SmoosherBatch): one register of each
+    // for every register of channels
+    struct LaneCoefficients
+    {
+        std::array<Lanes, maxRegisters> lpCoeff {};
+        std::array<Lanes, maxRegisters> hpCoeff {};
+        std::array<Lanes, maxRegisters> attackCoeff {};
+        std::array<Lanes, maxRegisters> releaseCoeff {};
+        std::array<Lanes, maxRegisters> sibilanceSensitivity {};
+    };
+
+    // process() with the internal key and per-lane coefficients, which start
+    // at `coefficients` and advance by `increment` every sample
+    void processLanes (Lanes* frames, Lanes* envelopeFrames, int numSamples,
+                       const LaneCoefficients& coefficients, const LaneCoefficients& increment) noexcept;
+
+    // Largest per-channel envelope, and a way to set them all, so switching
+    // between linked and per-channel detection continues from the same level
+    SampleType getMaxEnvelope() const noexcept;
+    void setEnvelope (SampleType value) noexcept;
+
+    // True if every state variable in every lane is within +-threshold
+    bool isSilent (SampleType threshold) const noexcept;
+
+    void reset() noexcept;
+
+    // Clears the state of numLanes lanes only, starting at lane firstLane
+    // (counted across the registers)
+    void resetLanes (int firstLane, int numLanes) noexcept;
+
+    // Copies up to `width` channels into / out of interleaved frames of
+    // `width` floats. Unused lanes are filled with silence on the way in. A
+    // non-zero fixedChannels replaces numChannels with a compile-time count
+    // (and the width with laneWidth, since such groups use one register).
+    template <int fixedChannels = 0>
+    static void interleave (const SampleType* const* channels, int numChannels, Lanes* frames, int width, int numSamples) noexcept
+    {
+        const int n = fixedChannels > 0 ? fixedChannels : numChannels;
+        const int w = fixedChannels > 0 ? laneWidth : width;
+        auto* data = reinterpret_cast<SampleType*> (frames);
+
+        for (int sample = 0; sample < numSamples; ++sample)
+            for (int lane = 0; lane < w; ++lane)
+                data[sample * w + lane] = lane < n ? channels[lane][sample] : SampleType (0);
+    }
+
+    template <int fixedChannels = 0>
+    static void deinterleave (const Lanes* frames, SampleType* const* channels, int numChannels, int width, int numSamples) noexcept
+    {
+        const int n = fixedChannels > 0 ? fixedChannels : numChannels;
+        const int w = fixedChannels > 0 ? laneWidth : width;
+        const auto* data = reinterpret_cast<const SampleType*> (frames);
+
+        for (int channel = 0; channel < n; ++channel)
+            for (int sample = 0; sample < numSamples; ++sample)
+                channels[channel][sample] = data[sample * w + channel];
+    }
+
+private:
+    template <bool followEnvelope>
+    void processFrom (KeySource source, Lanes* frames, Lanes* envelopeFrames, int numSamples,
+                      const SmooshSettings& settings, const SmooshSettings& increment) noexcept;
+
+    // Coefficients is one of the coefficient sources in ChannelLanes.cpp: the
+    // same SmooshSettings for every lane, or LaneCoefficients
+    template <bool followEnvelope, KeySource source, typename Coefficients>
+    void processGroup (Lanes* frames, Lanes* envelopeFrames, int numSamples, const Coefficients& coefficients) noexcept;
+
+    template <int registers, bool followEnvelope, KeySource source, typename Coefficients>
+    void processRegisters (Lanes* frames, Lanes* envelopeFrames, int numSamples, Coefficients coefficients) noexcept;
+
+    template <int registers>
+    void processLowPassRegisters (Lanes* frames, int numSamples, SmooshSettings settings, const SmooshSettings& increment) noexcept;
+
+    template <int registers>
+    static void applyControlGainRegisters (Lanes* frames, const Lanes* gainFrames, int numSamples, int rate) noexcept;
+};
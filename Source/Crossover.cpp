@@ -0,0 +1,124 @@
+#include "Crossover.h"
+
+//==============================================================================
+namespace
+{
+    constexpr double sqrt2 = 1.4142135623730951;
+
+    // One 2nd order Butterworth state variable section, returning its low-,
+    // band- and high-pass outputs
+    template <typename Lanes>
+    struct SectionOutputs
+    {
+        Lanes low, band, high;
+    };
+
+    template <typename Lanes>
+    SectionOutputs<Lanes> tick (Lanes input, Lanes& s1, Lanes& s2, Lanes g, Lanes r2PlusG, Lanes h) noexcept
+    {
+        SectionOutputs<Lanes> out;
+        out.high = (input - r2PlusG * s1 - s2) * h;
+        out.band = g * out.high + s1;
+        s1 = g * out.high + out.band;
+        out.low = g * out.band + s2;
+        s2 = g * out.band + out.low;
+        return out;
+    }
+}
+
+//==============================================================================
+template <typename SampleType>
+typename Crossover<SampleType>::Coefficients Crossover<SampleType>::makeCoefficients (double frequency, double sampleRate) noexcept
+{
+    const auto g = std::tan (juce::MathConstants<double>::pi * juce::jmin (frequency, sampleRate * 0.45) / sampleRate);
+
+    Coefficients c;
+    c.g = static_cast<SampleType> (g);
+    c.r2PlusG = static_cast<SampleType> (sqrt2 + g);
+    c.h = static_cast<SampleType> (1.0 / (1.0 + sqrt2 * g + g * g));
+    return c;
+}
+
+template <typename SampleType>
+void Crossover<SampleType>::process (const Lanes* frames, Lanes* bandFrames, int numSamples, int numBands,
+                                     const Coefficients& low, const Coefficients& high) noexcept
+{
+    jassert (numBands == 2 || numBands == 3);
+
+    if (numBands == 2)
+        processBands<2> (frames, bandFrames, numSamples, low, high);
+    else
+        processBands<3> (frames, bandFrames, numSamples, low, high);
+}
+
+template <typename SampleType>
+template <int numBands>
+void Crossover<SampleType>::processBands (const Lanes* frames, Lanes* bandFrames, int numSamples,
+                                          const Coefficients& low, const Coefficients& high) noexcept
+{
+    // Local copies so the state stays in registers for the whole block
+    auto lo = lowSplit;
+    auto hi = highSplit;
+    auto ap = lowAllpass;
+
+    const auto lowG = Lanes::expand (low.g), lowR2PlusG = Lanes::expand (low.r2PlusG), lowH = Lanes::expand (low.h);
+    const auto highG = Lanes::expand (high.g), highR2PlusG = Lanes::expand (high.r2PlusG), highH = Lanes::expand (high.h);
+    const auto r2 = static_cast<SampleType> (sqrt2);
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        // Low crossover: LR4 low-pass, and the high-pass as the allpass minus it
+        const auto a = tick (frames[i], lo[0], lo[1], lowG, lowR2PlusG, lowH);
+        const auto b = tick (a.low, lo[2], lo[3], lowG, lowR2PlusG, lowH);
+        const auto lowBand = b.low;
+        const auto upper = a.low - a.band * r2 + a.high - lowBand;
+
+        if constexpr (numBands == 2)
+        {
+            bandFrames[i] = lowBand;
+            bandFrames[numSamples + i] = upper;
+        }
+        else
+        {
+            // High crossover on the upper band
+            const auto c = tick (upper, hi[0], hi[1], highG, highR2PlusG, highH);
+            const auto d = tick (c.low, hi[2], hi[3], highG, highR2PlusG, highH);
+            const auto highBand = c.low - c.band * r2 + c.high - d.low;
+
+            // Same phase shift on the low band, so the three still sum to an allpass
+            const auto e = tick (lowBand, ap[0], ap[1], highG, highR2PlusG, highH);
+
+            bandFrames[i] = e.low - e.band * r2 + e.high;
+            bandFrames[numSamples + i] = d.low;
+            bandFrames[2 * numSamples + i] = highBand;
+        }
+    }
+
+    lowSplit = lo;
+    highSplit = hi;
+    lowAllpass = ap;
+}
+
+//==============================================================================
+template <typename SampleType>
+bool Crossover<SampleType>::isSilent (SampleType threshold) const noexcept
+{
+    auto peak = Lanes::expand (SampleType (0));
+
+    for (const auto* states : { lowSplit.data(), highSplit.data() })
+        for (int i = 0; i < 4; ++i)
+            peak = Lanes::max (peak, Lanes::max (states[i], Lanes::expand (SampleType (0)) - states[i]));
+
+    for (auto state : lowAllpass)
+        peak = Lanes::max (peak, Lanes::max (state, Lanes::expand (SampleType (0)) - state));
+
+    for (size_t lane = 0; lane < Lanes::SIMDNumElements; ++lane)
+        if (peak.get (lane) > threshold)
+            return false;
+
+    return true;
+}
+
+//==============================================================================
+template struct Crossover<float>;
+template struct Crossover<double>;
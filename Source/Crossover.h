@@ -0,0 +1,52 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+
+//==============================================================================
+// Linkwitz-Riley (4th order) band splitting for a group of channels, one
+// channel per SIMD lane like ChannelLanes.
+//
+// Two bands split once at the low crossover. Three bands split the upper band
+// again at the high crossover and pass the low band through the matching
+// allpass, so the bands always sum back to an allpassed (flat magnitude)
+// version of the input. The filters are topology-preserving state variable
+// sections (the same structure as juce::dsp::LinkwitzRileyFilter), which stay
+// well behaved when the crossover frequencies move.
+template <typename SampleType>
+struct Crossover
+{
+    using Lanes = juce::dsp::SIMDRegister<SampleType>;
+    static constexpr int laneWidth = static_cast<int> (Lanes::SIMDNumElements);
+    static constexpr int maxBands = 3;
+
+    // Per-frequency constants of the state variable sections
+    struct Coefficients
+    {
+        SampleType g = 0;           // tan (pi fc / fs)
+        SampleType r2PlusG = 0;     // sqrt (2) + g
+        SampleType h = 0;           // 1 / (1 + sqrt (2) g + g^2)
+    };
+
+    // Frequencies are kept a little below Nyquist
+    static Coefficients makeCoefficients (double frequency, double sampleRate) noexcept;
+
+    // Splits numSamples frames into numBands (2 or 3) bands. Band b of frame i
+    // goes to bandFrames[b * numSamples + i], lowest band first.
+    void process (const Lanes* frames, Lanes* bandFrames, int numSamples, int numBands,
+                  const Coefficients& low, const Coefficients& high) noexcept;
+
+    // True if every state variable in every lane is within +-threshold
+    bool isSilent (SampleType threshold) const noexcept;
+
+    void reset() noexcept { *this = {}; }
+
+    // Two 2nd order sections per crossover, plus the low band's allpass
+    std::array<Lanes, 4> lowSplit {};
+    std::array<Lanes, 4> highSplit {};
+    std::array<Lanes, 2> lowAllpass {};
+
+private:
+    template <int numBands>
+    void processBands (const Lanes* frames, Lanes* bandFrames, int numSamples,
+                       const Coefficients& low, const Coefficients& high) noexcept;
+};
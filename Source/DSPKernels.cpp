@@ -0,0 +1,243 @@
+#define DSPKERNELS_ISA baseline
+#include "DSPKernelsImpl.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+
+#if SMOOSHER_DSP_ISA_DISPATCH && defined (_MSC_VER)
+ #include <intrin.h>
+#endif
+
+namespace DSPKernels
+{
+
+#if SMOOSHER_DSP_ISA_DISPATCH
+namespace avx2   { extern const KernelTable kernels; }
+namespace avx512 { extern const KernelTable kernels; }
+#endif
+
+//==============================================================================
+namespace
+{
+    bool cpuSupports (InstructionSet isa) noexcept
+    {
+       #if SMOOSHER_DSP_ISA_DISPATCH
+        #if defined (_MSC_VER) && ! defined (__clang__)
+         // CPUID leaf 7 for the feature bits, XGETBV for the OS saving the wide registers
+         int info[4];
+         __cpuid (info, 0);
+         if (info[0] < 7)
+             return false;
+
+         __cpuid (info, 1);
+         const bool osxsave = (info[2] & (1 << 27)) != 0;
+         if (! osxsave)
+             return false;
+
+         const auto xcr0 = _xgetbv (0);
+         __cpuidex (info, 7, 0);
+
+         switch (isa)
+         {
+             case InstructionSet::avx2:     return (xcr0 & 0x06) == 0x06 && (info[1] & (1 << 5)) != 0;
+             case InstructionSet::avx512:   return (xcr0 & 0xe6) == 0xe6 && (info[1] & (1 << 16)) != 0;
+             case InstructionSet::baseline: break;
+         }
+        #else
+         __builtin_cpu_init();
+
+         switch (isa)
+         {
+             case InstructionSet::avx2:     return __builtin_cpu_supports ("avx2");
+             case InstructionSet::avx512:   return __builtin_cpu_supports ("avx512f");
+             case InstructionSet::baseline: break;
+         }
+        #endif
+       #endif
+
+        return isa == InstructionSet::baseline;
+    }
+
+    const KernelTable& getKernels (InstructionSet isa) noexcept
+    {
+       #if SMOOSHER_DSP_ISA_DISPATCH
+        switch (isa)
+        {
+            case InstructionSet::avx2:     return avx2::kernels;
+            case InstructionSet::avx512:   return avx512::kernels;
+            case InstructionSet::baseline: break;
+        }
+       #endif
+
+        (void) isa;
+        return baseline::kernels;
+    }
+
+    InstructionSet getDefaultInstructionSet() noexcept
+    {
+        if (const char* forced = std::getenv ("SMOOSHER_DSP_ISA"))
+        {
+            if (std::strcmp (forced, "baseline") == 0)
+                return InstructionSet::baseline;
+
+            // Unknown or unsupported names fall through to auto-detection
+            for (auto isa : { InstructionSet::baseline, InstructionSet::avx2, InstructionSet::avx512 })
+                if (std::strcmp (forced, getName (isa)) == 0 && isSupported (isa))
+                    return isa;
+        }
+
+        if (isSupported (InstructionSet::avx512))
+            return InstructionSet::avx512;
+
+        if (isSupported (InstructionSet::avx2))
+            return InstructionSet::avx2;
+
+        return InstructionSet::baseline;
+    }
+
+    // Function-local, so the choice is made the first time any kernel runs
+    // rather than during static initialisation
+    std::atomic<InstructionSet>& activeInstructionSet() noexcept
+    {
+        static std::atomic<InstructionSet> active { getDefaultInstructionSet() };
+        return active;
+    }
+
+    const KernelTable& active() noexcept
+    {
+        return getKernels (activeInstructionSet().load (std::memory_order_relaxed));
+    }
+
+    // The float or double kernels, picked by the type of a data pointer
+    const Kernels<float>& activeFor (const float*) noexcept   { return active().floatKernels; }
+    const Kernels<double>& activeFor (const double*) noexcept { return active().doubleKernels; }
+    const LaneKernels& activeLanes() noexcept                 { return active().laneKernels; }
+}
+
+//==============================================================================
+bool isSupported (InstructionSet isa) noexcept
+{
+    return cpuSupports (isa);
+}
+
+InstructionSet getInstructionSet() noexcept
+{
+    return activeInstructionSet().load();
+}
+
+bool setInstructionSet (InstructionSet isa) noexcept
+{
+    if (! isSupported (isa))
+        return false;
+
+    activeInstructionSet().store (isa);
+    return true;
+}
+
+const char* getName (InstructionSet isa) noexcept
+{
+    switch (isa)
+    {
+        case InstructionSet::avx2:     return "avx2";
+        case InstructionSet::avx512:   return "avx512";
+        case InstructionSet::baseline: break;
+    }
+
+   #if defined (__aarch64__) || defined (_M_ARM64)
+    return "neon";
+   #else
+    return "sse2";
+   #endif
+}
+
+//==============================================================================
+Levels measureLevels (const float* data, int numSamples) noexcept
+{
+    return activeFor (data).measureLevels (data, numSamples);
+}
+
+Levels measureLevels (const double* data, int numSamples) noexcept
+{
+    return activeFor (data).measureLevels (data, numSamples);
+}
+
+void applyGain (float* dest, const float* src, int numSamples, Ramp gain) noexcept
+{
+    activeFor (dest).applyGain (dest, src, numSamples, gain);
+}
+
+void applyGain (double* dest, const double* src, int numSamples, Ramp gain) noexcept
+{
+    activeFor (dest).applyGain (dest, src, numSamples, gain);
+}
+
+void saturate (float* data, int numSamples, Ramp amount) noexcept
+{
+    activeFor (data).saturate (data, numSamples, amount);
+}
+
+void saturate (double* data, int numSamples, Ramp amount) noexcept
+{
+    activeFor (data).saturate (data, numSamples, amount);
+}
+
+void softLimit (float* data, int numSamples) noexcept
+{
+    activeFor (data).softLimit (data, numSamples);
+}
+
+void softLimit (double* data, int numSamples) noexcept
+{
+    activeFor (data).softLimit (data, numSamples);
+}
+
+void mixDryWet (float* out, const float* dry, const float* wet, int numSamples,
+                Ramp makeupGain, Ramp outputGain, Ramp mix) noexcept
+{
+    activeFor (out).mixDryWet (out, dry, wet, numSamples, makeupGain, outputGain, mix);
+}
+
+void mixDryWet (double* out, const double* dry, const double* wet, int numSamples,
+                Ramp makeupGain, Ramp outputGain, Ramp mix) noexcept
+{
+    activeFor (out).mixDryWet (out, dry, wet, numSamples, makeupGain, outputGain, mix);
+}
+
+void applyGainComputer (float* data, const float* envelope, int numSamples, int frameSize,
+                        Ramp thresholdLog2, Ramp compressionSlope) noexcept
+{
+    activeFor (data).applyGainComputer (data, envelope, numSamples, frameSize, thresholdLog2, compressionSlope);
+}
+
+void applyGainComputer (double* data, const double* envelope, int numSamples, int frameSize,
+                        Ramp thresholdLog2, Ramp compressionSlope) noexcept
+{
+    activeFor (data).applyGainComputer (data, envelope, numSamples, frameSize, thresholdLog2, compressionSlope);
+}
+
+//==============================================================================
+void applyLaneGain (float* dest, const float* src, int numSamples, int frameSize, LaneRamps gain) noexcept
+{
+    activeLanes().applyLaneGain (dest, src, numSamples, frameSize, gain);
+}
+
+void saturateLanes (float* data, int numSamples, int frameSize, LaneRamps amount) noexcept
+{
+    activeLanes().saturateLanes (data, numSamples, frameSize, amount);
+}
+
+void applyLaneGainComputer (float* data, const float* envelope, int numSamples, int frameSize,
+                            LaneRamps thresholdLog2, LaneRamps compressionSlope) noexcept
+{
+    activeLanes().applyLaneGainComputer (data, envelope, numSamples, frameSize, thresholdLog2, compressionSlope);
+}
+
+void mixDryWetLanes (float* out, const float* dry, const float* wet, int numSamples, int frameSize,
+                     LaneRamps makeupGain, LaneRamps outputGain, LaneRamps mix, const bool* limit) noexcept
+{
+    activeLanes().mixDryWetLanes (out, dry, wet, numSamples, frameSize, makeupGain, outputGain, mix, limit);
+}
+
+}
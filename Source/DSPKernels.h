@@ -0,0 +1,119 @@
+#pragma once
+
+//==============================================================================
+// Whole-block kernels for the stages of the Smoosher chain. Each one is a plain
+// C++ loop over contiguous samples, written without libm calls or branches in
+// the loop body so the compiler vectorizes it (SSE/NEON and up).
+//
+// The loops are built once per instruction set (DSPKernelsImpl.h) and the
+// functions below forward to the widest version the CPU supports, picked the
+// first time a kernel runs. None of them enable FMA contraction, so every x86
+// version produces bit-identical output and a render does not depend on which
+// machine in the farm it ran on.
+//
+// Every kernel comes in float and double. The double versions back the
+// processor's double-precision path and take the same float ramps. The
+// per-lane kernels at the end, for SmoosherBatch, are float only.
+//
+// The processor runs them in this order over scratch buffers sized in
+// prepareToPlay:
+//   applyGain (input) -> saturate -> ChannelLanes::process (recursive stage)
+//   -> applyGainComputer -> softLimit -> mixDryWet
+namespace DSPKernels
+{
+    // A value ramping linearly across a block: start + increment * sample
+    struct Ramp
+    {
+        float start = 0.0f;
+        float increment = 0.0f;
+
+        float at (int sample) const noexcept { return start + increment * static_cast<float> (sample); }
+    };
+
+    // A ramp per lane of interleaved frames, for frames whose lanes belong to
+    // different streams: start[lane] + increment[lane] * sample
+    struct LaneRamps
+    {
+        const float* start = nullptr;
+        const float* increment = nullptr;
+
+        float at (int lane, int sample) const noexcept { return start[lane] + increment[lane] * static_cast<float> (sample); }
+    };
+
+    //==============================================================================
+    // Instruction sets the kernels are built for. `baseline` is whatever the
+    // target guarantees: SSE2 on x86-64, NEON on 64-bit ARM.
+    enum class InstructionSet
+    {
+        baseline,
+        avx2,
+        avx512
+    };
+
+    // True if the kernels were built for `isa` and this CPU can run them
+    bool isSupported (InstructionSet isa) noexcept;
+
+    InstructionSet getInstructionSet() noexcept;
+
+    // Forces a specific set of kernels, e.g. to compare paths in tests.
+    // Returns false and leaves the current choice alone if it isn't supported.
+    // The SMOOSHER_DSP_ISA environment variable ("baseline", "sse2", "neon",
+    // "avx2" or "avx512") does the same for the default choice.
+    bool setInstructionSet (InstructionSet isa) noexcept;
+
+    const char* getName (InstructionSet isa) noexcept;
+
+    //==============================================================================
+    // Peak magnitude and sum of squares of a block, for metering
+    struct Levels
+    {
+        float peak = 0.0f;
+        float sumOfSquares = 0.0f;
+    };
+
+    Levels measureLevels (const float* data, int numSamples) noexcept;
+    Levels measureLevels (const double* data, int numSamples) noexcept;
+
+    // dest = src * gain
+    void applyGain (float* dest, const float* src, int numSamples, Ramp gain) noexcept;
+    void applyGain (double* dest, const double* src, int numSamples, Ramp gain) noexcept;
+
+    // Tube-style saturation, blended with the clean signal by `amount`:
+    //   x + (tanh (1.5 x (1 + amount)) / 1.5 - x) * 2 amount
+    void saturate (float* data, int numSamples, Ramp amount) noexcept;
+    void saturate (double* data, int numSamples, Ramp amount) noexcept;
+
+    // Hammer-mode soft limiter: leaves |x| <= 0.95 untouched and soft-knees
+    // anything above into 0.95 + 0.05 tanh (2 (|x| - 0.95)).
+    void softLimit (float* data, int numSamples) noexcept;
+    void softLimit (double* data, int numSamples) noexcept;
+
+    // out = dry * (1 - mix) + wet * makeupGain * outputGain * mix
+    void mixDryWet (float* out, const float* dry, const float* wet, int numSamples,
+                    Ramp makeupGain, Ramp outputGain, Ramp mix) noexcept;
+    void mixDryWet (double* out, const double* dry, const double* wet, int numSamples,
+                    Ramp makeupGain, Ramp outputGain, Ramp mix) noexcept;
+
+    //==============================================================================
+    // Gain computer over a whole block of interleaved frames (frameSize values
+    // per sample): multiplies each value by the gain reduction for its envelope
+    // value. Not recursive, so it runs across lanes and frames at full vector width.
+    void applyGainComputer (float* data, const float* envelope, int numSamples, int frameSize,
+                            Ramp thresholdLog2, Ramp compressionSlope) noexcept;
+    void applyGainComputer (double* data, const double* envelope, int numSamples, int frameSize,
+                            Ramp thresholdLog2, Ramp compressionSlope) noexcept;
+
+    //==============================================================================
+    // applyGain, saturate, applyGainComputer and mixDryWet over interleaved
+    // frames of frameSize lanes, with every ramp given per lane. Each lane
+    // computes exactly what the single-ramp kernel would for its channel.
+    void applyLaneGain (float* dest, const float* src, int numSamples, int frameSize, LaneRamps gain) noexcept;
+    void saturateLanes (float* data, int numSamples, int frameSize, LaneRamps amount) noexcept;
+    void applyLaneGainComputer (float* data, const float* envelope, int numSamples, int frameSize,
+                                LaneRamps thresholdLog2, LaneRamps compressionSlope) noexcept;
+
+    // mixDryWet, with the hammer-mode soft limiter applied after makeup gain
+    // in the lanes where limit[lane] is true
+    void mixDryWetLanes (float* out, const float* dry, const float* wet, int numSamples, int frameSize,
+                         LaneRamps makeupGain, LaneRamps outputGain, LaneRamps mix, const bool* limit) noexcept;
+}
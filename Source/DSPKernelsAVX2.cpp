@@ -0,0 +1,7 @@
+// AVX2 build of the DSP kernels. CMakeLists.txt adds the matching
+// compiler flags to this file only; DSPKernels.cpp calls into it after checking
+// the CPU supports it.
+#if SMOOSHER_DSP_ISA_DISPATCH
+ #define DSPKERNELS_ISA avx2
+ #include "DSPKernelsImpl.h"
+#endif
@@ -0,0 +1,275 @@
+#pragma once
+
+#include "DSPKernels.h"
+#include "FastMath.h"
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+//==============================================================================
+// Kernel bodies, compiled once per instruction set. Each translation unit that
+// includes this defines DSPKERNELS_ISA to a namespace name first, and is built
+// with the matching compiler flags (see CMakeLists.txt), so every copy lives in
+// its own namespace and only its kernel table is visible to the dispatcher.
+#ifndef DSPKERNELS_ISA
+ #error "Define DSPKERNELS_ISA before including DSPKernelsImpl.h"
+#endif
+
+namespace DSPKernels
+{
+    // One entry per kernel declared in DSPKernels.h, for one sample type
+    template <typename SampleType>
+    struct Kernels
+    {
+        Levels (*measureLevels) (const SampleType*, int) noexcept;
+        void (*applyGain) (SampleType*, const SampleType*, int, Ramp) noexcept;
+        void (*saturate) (SampleType*, int, Ramp) noexcept;
+        void (*softLimit) (SampleType*, int) noexcept;
+        void (*mixDryWet) (SampleType*, const SampleType*, const SampleType*, int, Ramp, Ramp, Ramp) noexcept;
+        void (*applyGainComputer) (SampleType*, const SampleType*, int, int, Ramp, Ramp) noexcept;
+    };
+
+    // The per-lane kernels, float only
+    struct LaneKernels
+    {
+        void (*applyLaneGain) (float*, const float*, int, int, LaneRamps) noexcept;
+        void (*saturateLanes) (float*, int, int, LaneRamps) noexcept;
+        void (*applyLaneGainComputer) (float*, const float*, int, int, LaneRamps, LaneRamps) noexcept;
+        void (*mixDryWetLanes) (float*, const float*, const float*, int, int, LaneRamps, LaneRamps, LaneRamps, const bool*) noexcept;
+    };
+
+    struct KernelTable
+    {
+        Kernels<float> floatKernels;
+        Kernels<double> doubleKernels;
+        LaneKernels laneKernels;
+    };
+
+namespace DSPKERNELS_ISA
+{
+
+//==============================================================================
+// Anything with external linkage that the kernels call and the compiler fails
+// to inline gets a weak copy built with this file's flags, and the linker may
+// pick that copy for every caller. So the kernels only call into this
+// namespace and FastMath (which is keyed on DSPKERNELS_ISA as well): these
+// stand in for Ramp::at, LaneRamps::at and the std:: sign and magnitude helpers.
+inline float rampAt (Ramp ramp, int sample) noexcept
+{
+    return ramp.start + ramp.increment * static_cast<float> (sample);
+}
+
+inline float rampAt (LaneRamps ramp, int lane, int sample) noexcept
+{
+    return ramp.start[lane] + ramp.increment[lane] * static_cast<float> (sample);
+}
+
+#if defined (__GNUC__)
+inline float copySign (float magnitude, float sign) noexcept    { return __builtin_copysignf (magnitude, sign); }
+inline double copySign (double magnitude, double sign) noexcept { return __builtin_copysign (magnitude, sign); }
+inline float absolute (float x) noexcept                        { return __builtin_fabsf (x); }
+inline double absolute (double x) noexcept                      { return __builtin_fabs (x); }
+#else
+// Plain bit operations, so there is nothing left for the compiler to call
+template <typename SampleType>
+inline SampleType copySign (SampleType magnitude, SampleType sign) noexcept
+{
+    using Bits = std::conditional_t<sizeof (SampleType) == 4, std::uint32_t, std::uint64_t>;
+    constexpr auto signBit = static_cast<Bits> (1) << (sizeof (Bits) * 8 - 1);
+
+    Bits m, s;
+    std::memcpy (&m, &magnitude, sizeof (m));
+    std::memcpy (&s, &sign, sizeof (s));
+    m = (m & ~signBit) | (s & signBit);
+    std::memcpy (&magnitude, &m, sizeof (m));
+
+    return magnitude;
+}
+
+template <typename SampleType>
+inline SampleType absolute (SampleType x) noexcept
+{
+    return copySign (x, SampleType (0));
+}
+#endif
+
+//==============================================================================
+// The bodies are templates over the sample type. The FastMath approximations
+// stay in float for double blocks: their own error (around 1e-7) is already
+// larger than float rounding, and the signal path around them stays double.
+template <typename SampleType>
+Levels measureLevels (const SampleType* data, int numSamples) noexcept
+{
+    // One accumulator per position in a group, so the loop vectorizes without
+    // reassociating the float additions (which the compiler may not do itself)
+    constexpr int groupSize = 16;
+    SampleType peak[groupSize] = {};
+    SampleType sum[groupSize] = {};
+
+    int i = 0;
+    for (; i + groupSize <= numSamples; i += groupSize)
+    {
+        for (int j = 0; j < groupSize; ++j)
+        {
+            const SampleType x = data[i + j];
+            peak[j] = FastMath::maximum (peak[j], absolute (x));
+            sum[j] += x * x;
+        }
+    }
+
+    for (int j = 0; i < numSamples; ++i, ++j)
+    {
+        peak[j] = FastMath::maximum (peak[j], absolute (data[i]));
+        sum[j] += data[i] * data[i];
+    }
+
+    SampleType maxPeak = 0, sumOfSquares = 0;
+    for (int j = 0; j < groupSize; ++j)
+    {
+        maxPeak = FastMath::maximum (maxPeak, peak[j]);
+        sumOfSquares += sum[j];
+    }
+
+    return { static_cast<float> (maxPeak), static_cast<float> (sumOfSquares) };
+}
+
+template <typename SampleType>
+void applyGain (SampleType* dest, const SampleType* src, int numSamples, Ramp gain) noexcept
+{
+    for (int i = 0; i < numSamples; ++i)
+        dest[i] = src[i] * rampAt (gain, i);
+}
+
+template <typename SampleType>
+inline SampleType saturateSample (SampleType x, float a) noexcept
+{
+    // Soft clipping with tanh for tube-like saturation
+    const auto shaped = FastMath::fastTanh (static_cast<float> (x * (1.0f + a) * 1.5f));
+    const auto saturated = static_cast<SampleType> (shaped) * static_cast<SampleType> (1.0f / 1.5f);
+
+    // Blend between clean and saturated based on saturation amount
+    return x + (saturated - x) * a * 2.0f;
+}
+
+template <typename SampleType>
+void saturate (SampleType* data, int numSamples, Ramp amount) noexcept
+{
+    for (int i = 0; i < numSamples; ++i)
+        data[i] = saturateSample (data[i], rampAt (amount, i));
+}
+
+template <typename SampleType>
+inline SampleType softLimitSample (SampleType x) noexcept
+{
+    constexpr SampleType limitThreshold = static_cast<SampleType> (0.95f);
+    const SampleType magnitude = absolute (x);
+
+    // Below the threshold the excess is zero and tanh (0) adds nothing,
+    // so no branch is needed to leave quiet samples untouched
+    const SampleType clipped = FastMath::minimum (magnitude, limitThreshold);
+    const auto knee = FastMath::fastTanh (static_cast<float> ((magnitude - clipped) * 2.0f));
+    const SampleType limited = clipped + static_cast<SampleType> (knee) * static_cast<SampleType> (0.05f);
+
+    return copySign (limited, x);
+}
+
+template <typename SampleType>
+void softLimit (SampleType* data, int numSamples) noexcept
+{
+    for (int i = 0; i < numSamples; ++i)
+        data[i] = softLimitSample (data[i]);
+}
+
+template <typename SampleType>
+void mixDryWet (SampleType* out, const SampleType* dry, const SampleType* wet, int numSamples,
+                Ramp makeupGain, Ramp outputGain, Ramp mix) noexcept
+{
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float m = rampAt (mix, i);
+        out[i] = dry[i] * (1.0f - m) + wet[i] * rampAt (makeupGain, i) * rampAt (outputGain, i) * m;
+    }
+}
+
+//==============================================================================
+template <typename SampleType>
+void applyGainComputer (SampleType* data, const SampleType* envelope, int numSamples, int frameSize,
+                        Ramp thresholdLog2, Ramp compressionSlope) noexcept
+{
+    for (int sample = 0; sample < numSamples; ++sample)
+    {
+        const float threshold = rampAt (thresholdLog2, sample);
+        const float slope = rampAt (compressionSlope, sample);
+
+        for (int i = sample * frameSize; i < (sample + 1) * frameSize; ++i)
+        {
+            // Gain reduction, exactly 1 below threshold
+            data[i] *= FastMath::computeGain (static_cast<float> (envelope[i]), threshold, slope);
+        }
+    }
+}
+
+//==============================================================================
+// Per-lane versions. The lane loop is innermost, so each one vectorizes
+// across the lanes of a frame.
+inline void applyLaneGain (float* dest, const float* src, int numSamples, int frameSize, LaneRamps gain) noexcept
+{
+    for (int sample = 0; sample < numSamples; ++sample)
+        for (int lane = 0; lane < frameSize; ++lane)
+            dest[sample * frameSize + lane] = src[sample * frameSize + lane] * rampAt (gain, lane, sample);
+}
+
+inline void saturateLanes (float* data, int numSamples, int frameSize, LaneRamps amount) noexcept
+{
+    for (int sample = 0; sample < numSamples; ++sample)
+        for (int lane = 0; lane < frameSize; ++lane)
+            data[sample * frameSize + lane] = saturateSample (data[sample * frameSize + lane], rampAt (amount, lane, sample));
+}
+
+inline void applyLaneGainComputer (float* data, const float* envelope, int numSamples, int frameSize,
+                                   LaneRamps thresholdLog2, LaneRamps compressionSlope) noexcept
+{
+    for (int sample = 0; sample < numSamples; ++sample)
+        for (int lane = 0; lane < frameSize; ++lane)
+            data[sample * frameSize + lane] *= FastMath::computeGain (envelope[sample * frameSize + lane],
+                                                                      rampAt (thresholdLog2, lane, sample),
+                                                                      rampAt (compressionSlope, lane, sample));
+}
+
+inline void mixDryWetLanes (float* out, const float* dry, const float* wet, int numSamples, int frameSize,
+                            LaneRamps makeupGain, LaneRamps outputGain, LaneRamps mix, const bool* limit) noexcept
+{
+    for (int sample = 0; sample < numSamples; ++sample)
+    {
+        for (int lane = 0; lane < frameSize; ++lane)
+        {
+            const auto i = sample * frameSize + lane;
+            const float m = rampAt (mix, lane, sample);
+
+            // Same operation order as applyGain + softLimit + mixDryWet with
+            // unity makeup, and as mixDryWet alone
+            const float made = wet[i] * rampAt (makeupGain, lane, sample);
+            const float limited = softLimitSample (made);
+            const float w = limit[lane] ? limited : made;
+
+            out[i] = dry[i] * (1.0f - m) + w * rampAt (outputGain, lane, sample) * m;
+        }
+    }
+}
+
+//==============================================================================
+extern const KernelTable kernels;
+
+template <typename SampleType>
+constexpr Kernels<SampleType> kernelsFor() noexcept
+{
+    return { measureLevels<SampleType>, applyGain<SampleType>, saturate<SampleType>,
+             softLimit<SampleType>, mixDryWet<SampleType>, applyGainComputer<SampleType> };
+}
+
+const KernelTable kernels { kernelsFor<float>(), kernelsFor<double>(),
+                           { applyLaneGain, saturateLanes, applyLaneGainComputer, mixDryWetLanes } };
+
+}
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <array>
+
+//==============================================================================
+// Factory presets, shared by the editor's preset menu and the command line tools.
+// Values are in parameter units: Smoosh %, Input dB (0-30), Output dB (-12 to +12).
+struct FactoryPreset
+{
+    const char* name;
+    float smoosh;
+    float inputGain;
+    float outputGain;
+};
+
+inline constexpr std::array<FactoryPreset, 7> factoryPresets
+{{
+    { "Hell Smarsh",       45.0f, 15.0f, 1.0f },
+    { "Wenger's 7-String", 60.0f, 10.5f, 2.0f },
+    { "That Joe Sound",    70.0f, 15.0f, 0.0f },
+    { "Gravy River",       70.0f, 12.0f, 2.0f },
+    { "Dani Time",         30.0f, 35.0f, 2.0f },
+    { "Gloopy",            40.0f,  7.5f, 1.0f },
+    { "Limit THIS!",       75.0f, 24.0f, 3.0f },
+}};
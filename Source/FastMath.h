@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+//==============================================================================
+// Branch-free float approximations for the per-sample hot path.
+// These only use integer/float bit tricks and short polynomials, so loops that
+// call them auto-vectorize (no libm calls, no table lookups).
+//
+// These functions are inline with external linkage, so every translation unit
+// that doesn't inline a call emits a weak copy and the linker keeps just one.
+// The DSP kernels include this once per instruction set with different
+// compiler flags (see DSPKernelsImpl.h), so each of those gets a namespace of
+// its own. Otherwise an AVX2 copy could end up called from baseline code.
+#ifdef DSPKERNELS_ISA
+ #define FASTMATH_ISA DSPKERNELS_ISA
+#else
+ #define FASTMATH_ISA portable
+#endif
+
+namespace FastMath
+{
+inline namespace FASTMATH_ISA
+{
+    // std::min/max are weak templates too, so these stand in for them
+    template <typename T> inline T minimum (T a, T b) noexcept { return b < a ? b : a; }
+    template <typename T> inline T maximum (T a, T b) noexcept { return a < b ? b : a; }
+
+    //==============================================================================
+    // log2(x) for x > 0. Splits x into exponent and mantissa m in [1, 2) and
+    // evaluates log2(m) with a 6th order near-minimax polynomial.
+    // Max absolute error: 2.1e-6 for the polynomial, 3.2e-6 including float
+    // rounding over 1e-6..1e3 (in log2 units, i.e. about 2e-5 dB).
+    // Zero and denormals return roughly -127 instead of -inf.
+    inline float fastLog2 (float x) noexcept
+    {
+        std::uint32_t bits;
+        std::memcpy (&bits, &x, sizeof (bits));
+
+        const auto exponent = static_cast<float> (static_cast<std::int32_t> (bits >> 23) - 127);
+
+        bits = (bits & 0x007fffffu) | 0x3f800000u;
+        float m;
+        std::memcpy (&m, &bits, sizeof (m));
+
+        const float t = m - 1.0f;
+        const float p = 1.4425531349f + t * (-0.7182817784f + t * (0.4582701637f + t * (-0.2795368505f
+                      + t * (0.1234503122f + t * -0.0264570504f))));
+
+        return exponent + t * p;
+    }
+
+    //==============================================================================
+    // 2^x for |x| < 2^31, with the result clamped to the normal float range.
+    // Splits x into integer and fractional part f in [0, 1) and evaluates 2^f
+    // with a 5th order near-minimax polynomial. Max relative error: 8.3e-8 for
+    // the polynomial, 1.8e-7 including float rounding (1.5e-6 dB).
+    // fastExp2 (0) is exactly 1.
+    inline float fastExp2 (float x) noexcept
+    {
+        // floor() without libm: truncate, then step down for negative fractions
+        auto i = static_cast<std::int32_t> (x);
+        i -= static_cast<std::int32_t> (x < static_cast<float> (i));
+
+        const float f = x - static_cast<float> (i);
+        const float p = 1.0f + f * (0.6931513119f + f * (0.2401644497f + f * (0.0557999142f
+                      + f * (0.0090170292f + f * 0.0018671305f))));
+
+        // Clamping the integer part rather than x keeps the loop free of
+        // branches the compiler would otherwise thread on the clamp constants
+        i = minimum (maximum (i, -126), 127);
+
+        auto bits = static_cast<std::uint32_t> (i + 127) << 23;
+        float scale;
+        std::memcpy (&scale, &bits, sizeof (scale));
+
+        return p * scale;
+    }
+
+    //==============================================================================
+    // tanh(x) as a 13/6 odd/even rational approximation, with x clamped to
+    // +-7.9053 where the approximation reaches +-1 (the same one Eigen uses).
+    // Max absolute error vs. std::tanh: 4e-7 (-128 dB) over the whole float range.
+    inline float fastTanh (float x) noexcept
+    {
+        // Clamp |x| on the integer bit pattern (ordered like the float for
+        // positive values), which keeps the loop free of float compares
+        std::uint32_t bits;
+        std::memcpy (&bits, &x, sizeof (bits));
+        bits = (bits & 0x80000000u) | minimum (bits & 0x7fffffffu, 0x40fcf84fu);
+        std::memcpy (&x, &bits, sizeof (x));
+
+        const float x2 = x * x;
+
+        float p = -2.76076847742355e-16f;
+        p = p * x2 + 2.00018790482477e-13f;
+        p = p * x2 - 8.60467152213735e-11f;
+        p = p * x2 + 5.12229709037114e-08f;
+        p = p * x2 + 1.48572235717979e-05f;
+        p = p * x2 + 6.37261928875436e-04f;
+        p = p * x2 + 4.89352455891786e-03f;
+
+        float q = 1.19825839466702e-06f;
+        q = q * x2 + 1.18534705686654e-04f;
+        q = q * x2 + 2.26843463243900e-03f;
+        q = q * x2 + 4.89352518554385e-03f;
+
+        return x * p / q;
+    }
+
+    //==============================================================================
+    // Downward compressor gain computer in the log2 domain.
+    // Equivalent to decibelsToGain (-gainToDecibels (level / threshold) * slope)
+    // above threshold and 1 below, since the log base cancels out.
+    //
+    // Max error vs. that juce::Decibels path, measured over levels of -60..+30 dB
+    // and every threshold/ratio the Smoosh curve produces: 1.7e-5 dB. Below
+    // threshold the result is exactly 1.
+    inline float computeGain (float level, float thresholdLog2, float slope) noexcept
+    {
+        const float overLog2 = fastLog2 (level) - thresholdLog2;
+        return fastExp2 (-maximum (overLog2, 0.0f) * slope);
+    }
+}
+}
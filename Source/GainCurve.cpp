@@ -0,0 +1,116 @@
+#include "GainCurve.h"
+#include "DSPKernels.h"
+
+//==============================================================================
+void GainCurve::reset (int newNumChannels, juce::int64 numSamples)
+{
+    numChannels = juce::jmax (0, newNumChannels);
+    capacity = juce::jmax ((juce::int64) 0, numSamples);
+    length = 0;
+    finished = false;
+
+    // One more point than segments, for the end of the last one
+    pointsPerChannel = (capacity + decimation - 1) / decimation + 1;
+    points.assign ((size_t) (pointsPerChannel * numChannels), 1.0f);
+}
+
+template <typename SampleType>
+void GainCurve::record (int channel, juce::int64 position, const SampleType* gains, int numSamples) noexcept
+{
+    jassert (! finished && channel >= 0 && channel < numChannels);
+    if (finished || channel < 0 || channel >= numChannels)
+        return;
+
+    numSamples = (int) juce::jlimit ((juce::int64) 0, (juce::int64) numSamples, capacity - position);
+    auto* segments = points.data() + channel * pointsPerChannel;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        auto& segment = segments[(position + i) / decimation];
+        segment = juce::jmin (segment, static_cast<float> (gains[i]));
+    }
+}
+
+void GainCurve::extend (int numSamples) noexcept
+{
+    length = juce::jmin (capacity, length + numSamples);
+}
+
+void GainCurve::finish (int lookaheadSamples)
+{
+    jassert (! finished);
+    if (finished)
+        return;
+
+    // Segments of lookahead, rounded up: an attack in segment p + k starts
+    // reducing by segment p
+    const auto numSegments = (length + decimation - 1) / decimation;
+    const int lookahead = (juce::jmax (0, lookaheadSamples) + decimation - 1) / decimation;
+    std::vector<float> ahead ((size_t) numSegments);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto* channelPoints = points.data() + channel * pointsPerChannel;
+
+        // Smallest gain from each segment to `lookahead` segments later. On
+        // the release side (rising gain) that is the segment's own gain, so
+        // only attacks move.
+        for (juce::int64 p = 0; p < numSegments; ++p)
+        {
+            auto gain = channelPoints[p];
+
+            for (juce::int64 q = p + 1; q <= juce::jmin (p + lookahead, numSegments - 1); ++q)
+                gain = juce::jmin (gain, channelPoints[q]);
+
+            ahead[(size_t) p] = gain;
+        }
+
+        // Point p joins segments p - 1 and p, and takes the smaller gain, so
+        // the line to either neighbour stays at or below both segments
+        for (juce::int64 p = 0; p <= numSegments; ++p)
+        {
+            const auto before = p > 0 ? ahead[(size_t) (p - 1)] : 1.0f;
+            const auto after = p < numSegments ? ahead[(size_t) p] : 1.0f;
+            channelPoints[p] = juce::jmin (before, after);
+        }
+
+        std::fill (channelPoints + numSegments + 1, channelPoints + pointsPerChannel, 1.0f);
+    }
+
+    finished = true;
+}
+
+template <typename SampleType>
+void GainCurve::apply (int channel, juce::int64 position, SampleType* samples, int numSamples) const noexcept
+{
+    jassert (finished);
+    if (! finished || channel < 0 || channel >= numChannels)
+        return;
+
+    const auto* channelPoints = points.data() + channel * pointsPerChannel;
+    constexpr float step = 1.0f / (float) decimation;
+
+    // A straight-line ramp per segment, over the part of it in this block
+    for (int done = 0; done < numSamples;)
+    {
+        const auto sample = position + done;
+        const auto segment = sample / decimation;
+        const int offset = (int) (sample - segment * decimation);
+        const int count = juce::jmin (decimation - offset, numSamples - done);
+
+        if (sample >= length)
+            break;
+
+        const auto start = channelPoints[segment];
+        const auto increment = (channelPoints[segment + 1] - start) * step;
+        DSPKernels::applyGain (samples + done, samples + done, count, { start + increment * (float) offset, increment });
+
+        done += count;
+    }
+}
+
+//==============================================================================
+template void GainCurve::record (int, juce::int64, const float*, int) noexcept;
+template void GainCurve::record (int, juce::int64, const double*, int) noexcept;
+template void GainCurve::apply (int, juce::int64, float*, int) const noexcept;
+template void GainCurve::apply (int, juce::int64, double*, int) const noexcept;
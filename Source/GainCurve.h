@@ -0,0 +1,59 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+//==============================================================================
+// The compressor gain of a whole clip, computed ahead of time for two-pass
+// offline rendering (see SmoosherEngine::analyse()).
+//
+// The first pass records one gain per channel per sample, kept only as the
+// smallest gain (deepest reduction) of every segment of `decimation` samples.
+// finish() then shifts each attack earlier by the lookahead and turns the
+// segments into points that the second pass interpolates linearly between.
+// Every point is the smallest gain of the segments on either side of it, so
+// the interpolated gain never reduces less than the lookahead gain would at
+// any sample. The curve is compact: a float per channel per `decimation` samples.
+class GainCurve
+{
+public:
+    static constexpr int decimation = 16;
+
+    GainCurve() = default;
+
+    // Allocates room for numSamples samples of numChannels channels and
+    // starts recording from the beginning, with every gain at 1
+    void reset (int numChannels, juce::int64 numSamples);
+
+    int getNumChannels() const noexcept        { return numChannels; }
+    juce::int64 getLength() const noexcept     { return length; }
+    bool isFinished() const noexcept           { return finished; }
+
+    // Recording: folds the gains of samples position to position + numSamples
+    // - 1 into a channel's segments. Anything past the allocated length is
+    // dropped. Different channels may be recorded from different threads.
+    template <typename SampleType>
+    void record (int channel, juce::int64 position, const SampleType* gains, int numSamples) noexcept;
+
+    // Marks numSamples more samples as recorded, once every channel has them
+    void extend (int numSamples) noexcept;
+
+    // Applies the lookahead (rounded up to whole segments) and makes the
+    // curve ready to apply
+    void finish (int lookaheadSamples);
+
+    // Playback: multiplies samples position to position + numSamples - 1 of
+    // `samples` by the interpolated gain of `channel`. The gain is 1 past the
+    // recorded length, and for channels that weren't recorded.
+    template <typename SampleType>
+    void apply (int channel, juce::int64 position, SampleType* samples, int numSamples) const noexcept;
+
+private:
+    // Segment minima while recording, interpolation points once finished
+    // (point p sits on sample p * decimation), channel by channel
+    std::vector<float> points;
+    juce::int64 pointsPerChannel = 0;
+
+    int numChannels = 0;
+    juce::int64 length = 0, capacity = 0;
+    bool finished = false;
+};
@@ -0,0 +1,117 @@
+#include "MeterDisplay.h"
+
+//==============================================================================
+MeterDisplay::MeterDisplay()
+    : inputPeakDb (minLevelDb), inputRmsDb (minLevelDb), outputPeakDb (minLevelDb)
+{
+    setOpaque (true);
+}
+
+void MeterDisplay::update (const MeterFrame& latest)
+{
+    constexpr float release = releaseDbPerSecond / static_cast<float> (ticksPerSecond);
+
+    // Jump up to new peaks, fall back at the release rate
+    auto follow = [release] (float current, float target)
+    {
+        return juce::jmax (target, current - release);
+    };
+
+    auto toDb = [] (float gain) { return juce::Decibels::gainToDecibels (gain, minLevelDb); };
+
+    const auto previous = std::make_tuple (inputPeakDb, inputRmsDb, outputPeakDb, gainReductionDb);
+
+    inputPeakDb = follow (inputPeakDb, toDb (latest.inputPeak));
+    inputRmsDb = follow (inputRmsDb, toDb (latest.inputRms));
+    outputPeakDb = follow (outputPeakDb, toDb (latest.outputPeak));
+    gainReductionDb = juce::jmax (0.0f, latest.gainReductionDb, gainReductionDb - release);
+
+    // The history shows the raw per-tick maximum, without release
+    const bool historyWasFlat = historyNonZero == 0;
+    auto& slot = gainReductionHistory[(size_t) historyPosition];
+    historyNonZero += (latest.gainReductionDb > 0.0f ? 1 : 0) - (slot > 0.0f ? 1 : 0);
+    slot = latest.gainReductionDb;
+    historyPosition = (historyPosition + 1) % historySize;
+
+    // Only repaint what moved: on silence (or a bypassed knob) nothing does
+    if (previous != std::make_tuple (inputPeakDb, inputRmsDb, outputPeakDb, gainReductionDb))
+        repaint (barsArea.getSmallestIntegerContainer());
+
+    if (! (historyWasFlat && historyNonZero == 0))
+        repaint (historyArea.getSmallestIntegerContainer());
+}
+
+//==============================================================================
+void MeterDisplay::resized()
+{
+    auto bounds = getLocalBounds().toFloat();
+    barsArea = bounds.removeFromLeft (bounds.getWidth() * 0.4f).reduced (0.0f, 2.0f);
+    bounds.removeFromLeft (8.0f);
+    historyArea = bounds.reduced (0.0f, 2.0f);
+}
+
+void MeterDisplay::paint (juce::Graphics& g)
+{
+    g.fillAll (juce::Colour (0xff2a2a2a));
+
+    auto levelProportion = [] (float db) { return juce::jmap (db, minLevelDb, 0.0f, 0.0f, 1.0f); };
+
+    auto bars = barsArea;
+    const auto barHeight = bars.getHeight() / 3.0f;
+    drawBar (g, bars.removeFromTop (barHeight), "IN", levelProportion (inputRmsDb), levelProportion (inputPeakDb),
+             juce::Colour (0xff4caf50));
+    drawBar (g, bars.removeFromTop (barHeight), "OUT", levelProportion (outputPeakDb), 0.0f,
+             juce::Colour (0xff4caf50));
+    drawBar (g, bars, "GR", gainReductionDb / maxGainReductionDb, 0.0f,
+             juce::Colour (0xffe53935));
+
+    // Gain reduction history, newest on the right, hanging down from the top
+    g.setColour (juce::Colour (0xff1e1e1e));
+    g.fillRect (historyArea);
+
+    if (historyNonZero > 0)
+    {
+        historyPath.clear();
+        historyPath.startNewSubPath (historyArea.getX(), historyArea.getY());
+
+        for (int i = 0; i < historySize; ++i)
+        {
+            const auto value = gainReductionHistory[(size_t) ((historyPosition + i) % historySize)];
+            const auto x = historyArea.getX() + historyArea.getWidth() * static_cast<float> (i) / static_cast<float> (historySize - 1);
+            const auto y = historyArea.getY() + historyArea.getHeight() * juce::jlimit (0.0f, 1.0f, value / maxGainReductionDb);
+            historyPath.lineTo (x, y);
+        }
+
+        historyPath.lineTo (historyArea.getRight(), historyArea.getY());
+        historyPath.closeSubPath();
+
+        g.setColour (juce::Colour (0xffe53935).withAlpha (0.6f));
+        g.fillPath (historyPath);
+    }
+
+    g.setColour (juce::Colour (0xff606060));
+    g.drawRect (historyArea, 1.0f);
+}
+
+void MeterDisplay::drawBar (juce::Graphics& g, juce::Rectangle<float> area, const juce::String& label,
+                            float proportion, float secondaryProportion, juce::Colour colour) const
+{
+    area = area.reduced (0.0f, 1.5f);
+
+    g.setColour (juce::Colours::white);
+    g.setFont (juce::Font (10.0f, juce::Font::bold));
+    g.drawText (label, area.removeFromLeft (28.0f), juce::Justification::centredLeft);
+
+    g.setColour (juce::Colour (0xff1e1e1e));
+    g.fillRect (area);
+
+    // Secondary value (input peak) as a dimmer bar behind the main one
+    if (secondaryProportion > 0.0f)
+    {
+        g.setColour (colour.withAlpha (0.4f));
+        g.fillRect (area.withWidth (area.getWidth() * juce::jlimit (0.0f, 1.0f, secondaryProportion)));
+    }
+
+    g.setColour (colour);
+    g.fillRect (area.withWidth (area.getWidth() * juce::jlimit (0.0f, 1.0f, proportion)));
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "MeterFeed.h"
+
+//==============================================================================
+// Input/output level bars, a gain reduction bar and a scrolling gain
+// reduction history. Owns no timer: the editor drains the processor's
+// MeterFeed on its own timer and hands the result to update().
+class MeterDisplay : public juce::Component
+{
+public:
+    MeterDisplay();
+
+    // Takes the loudest values received since the last tick and scrolls the
+    // history one step, repainting only the parts that changed. Call at
+    // ticksPerSecond.
+    void update (const MeterFrame& latest);
+
+    void paint (juce::Graphics&) override;
+    void resized() override;
+
+    static constexpr int ticksPerSecond = 30;
+
+private:
+    static constexpr float minLevelDb = -60.0f;
+    static constexpr float maxGainReductionDb = 24.0f;
+
+    // Bars fall back at this rate after a peak
+    static constexpr float releaseDbPerSecond = 24.0f;
+
+    // One history column per tick, about 8 seconds
+    static constexpr int historySize = 240;
+
+    void drawBar (juce::Graphics& g, juce::Rectangle<float> area, const juce::String& label,
+                  float proportion, float secondaryProportion, juce::Colour colour) const;
+
+    float inputPeakDb, inputRmsDb, outputPeakDb;
+    float gainReductionDb = 0.0f;
+
+    std::array<float, historySize> gainReductionHistory {};
+    int historyPosition = 0;
+    int historyNonZero = 0;     // entries above 0 dB, so a flat history isn't repainted
+
+    juce::Rectangle<float> barsArea, historyArea;
+    juce::Path historyPath;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MeterDisplay)
+};
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+//==============================================================================
+// Levels for one processed block, linear (not dB) except gain reduction.
+struct MeterFrame
+{
+    float inputPeak = 0.0f;
+    float inputRms = 0.0f;
+    float outputPeak = 0.0f;
+    float gainReductionDb = 0.0f;   // largest reduction in the block, >= 0
+};
+
+//==============================================================================
+// Single-producer single-consumer queue of MeterFrames from the audio thread
+// to the editor. Both ends are wait-free (juce::AbstractFifo, a fixed array, no
+// locks or allocation). When the editor is closed or falls behind the queue
+// fills up and new frames are dropped rather than blocking the audio thread,
+// so a newly opened editor discards what's queued before it starts reading.
+class MeterFeed
+{
+public:
+    // About 170 ms of 32-sample blocks at 192 kHz, several seconds at usual sizes
+    static constexpr int capacity = 1024;
+
+    // Audio thread. Returns false if the frame was dropped.
+    bool push (const MeterFrame& frame) noexcept
+    {
+        const auto scope = fifo.write (1);
+
+        if (scope.blockSize1 > 0)
+            frames[(size_t) scope.startIndex1] = frame;
+        else if (scope.blockSize2 > 0)
+            frames[(size_t) scope.startIndex2] = frame;
+        else
+            return false;
+
+        return true;
+    }
+
+    // Editor thread. Calls fn (const MeterFrame&) for every queued frame, oldest
+    // first, and returns how many there were.
+    template <typename Fn>
+    int popAll (Fn&& fn)
+    {
+        const auto scope = fifo.read (fifo.getNumReady());
+
+        scope.forEach ([&] (int index) { fn (frames[(size_t) index]); });
+
+        return scope.blockSize1 + scope.blockSize2;
+    }
+
+    // Editor thread. Drops every queued frame and returns how many there were.
+    int discardAll() noexcept
+    {
+        return popAll ([] (const MeterFrame&) {});
+    }
+
+private:
+    juce::AbstractFifo fifo { capacity };
+    std::array<MeterFrame, capacity> frames;
+};
@@ -0,0 +1,71 @@
+#include "ParameterRamps.h"
+
+//==============================================================================
+void ParameterRamps::reset (const SmooshCurve& curve, double sampleRate) noexcept
+{
+    // Start every smoother at its target so playback doesn't begin with a ramp
+    smooshSmoothed.reset (sampleRate, smooshRampSeconds);
+    inputGainSmoothed.reset (sampleRate, gainRampSeconds);
+    outputGainSmoothed.reset (sampleRate, gainRampSeconds);
+    mixSmoothed.reset (sampleRate, gainRampSeconds);
+
+    inputGainSmoothed.setCurrentAndTargetValue (juce::Decibels::decibelsToGain (lastInputGainDB));
+    outputGainSmoothed.setCurrentAndTargetValue (juce::Decibels::decibelsToGain (lastOutputGainDB));
+
+    smooshSettings = curve.getSettings (smooshSmoothed.getCurrentValue());
+}
+
+void ParameterRamps::setTargets (float smoosh, float inputGainDb, float outputGainDb, float mix) noexcept
+{
+    if (inputGainDb != lastInputGainDB)
+    {
+        inputGainSmoothed.setTargetValue (juce::Decibels::decibelsToGain (inputGainDb));
+        lastInputGainDB = inputGainDb;
+    }
+
+    if (outputGainDb != lastOutputGainDB)
+    {
+        outputGainSmoothed.setTargetValue (juce::Decibels::decibelsToGain (outputGainDb));
+        lastOutputGainDB = outputGainDb;
+    }
+
+    mixSmoothed.setTargetValue (mix / 100.0f); // Convert to 0-1 range
+    smooshSmoothed.setTargetValue (smoosh);
+}
+
+BlockRamps ParameterRamps::next (const SmooshCurve& curve, int numSamples) noexcept
+{
+    // Every smoothed value is ramped linearly from its value at the start of the
+    // block to its value at the end. When nothing is moving the increments are zero.
+    BlockRamps ramps;
+    ramps.settings = smooshSettings;
+
+    if (smooshSmoothed.isSmoothing())
+        smooshSettings = curve.getSettings (smooshSmoothed.skip (numSamples));
+
+    ramps.increment = SmooshSettings::rampIncrement (ramps.settings, smooshSettings, numSamples);
+
+    auto rampOf = [numSamples] (auto& smoothed)
+    {
+        DSPKernels::Ramp ramp { smoothed.getCurrentValue(), 0.0f };
+        if (smoothed.isSmoothing())
+            ramp.increment = (smoothed.skip (numSamples) - ramp.start) / static_cast<float> (numSamples);
+        return ramp;
+    };
+
+    ramps.inputGain = rampOf (inputGainSmoothed);
+    ramps.outputGain = rampOf (outputGainSmoothed);
+    ramps.mix = rampOf (mixSmoothed);
+
+    ramps.compressionActive = ramps.settings.compressionActive || smooshSettings.compressionActive;
+    ramps.hammerMode = ramps.settings.hammerMode || smooshSettings.hammerMode;
+    ramps.saturationActive = juce::jmax (ramps.settings.saturationAmount, smooshSettings.saturationAmount) > 0.001f;
+
+    return ramps;
+}
+
+bool ParameterRamps::isSmoothing() const noexcept
+{
+    return smooshSmoothed.isSmoothing() || inputGainSmoothed.isSmoothing()
+        || outputGainSmoothed.isSmoothing() || mixSmoothed.isSmoothing();
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include "SmooshCurve.h"
+#include "DSPKernels.h"
+
+//==============================================================================
+// Start values and per-sample increments of everything ramped across a block
+struct BlockRamps
+{
+    SmooshSettings settings;
+    SmooshSettings increment;
+    DSPKernels::Ramp inputGain, outputGain, mix;
+
+    // While ramping across a mode boundary, the stages of either end keep running
+    bool compressionActive = false;
+    bool hammerMode = false;
+    bool saturationActive = false;
+};
+
+//==============================================================================
+// Smoothing for the continuous parameters of one Smoosher chain (smoosh,
+// input and output gain, mix). Gains ramp in the log domain, smoosh and mix
+// linearly, and each block gets straight-line ramps from where the smoothers
+// were at its start to where they are at its end, so the stages only need
+// one multiply-add per value per sample.
+class ParameterRamps
+{
+public:
+    static constexpr double smooshRampSeconds = 0.05;
+    static constexpr double gainRampSeconds = 0.02;
+
+    // Sets the ramp lengths for sampleRate and jumps straight to the targets
+    void reset (const SmooshCurve& curve, double sampleRate) noexcept;
+
+    // New targets, in the units of the plugin's parameters. Gains are only
+    // converted when their dB values have actually moved.
+    void setTargets (float smoosh, float inputGainDb, float outputGainDb, float mix) noexcept;
+
+    // Ramps for the next numSamples samples, advancing the smoothers past them
+    BlockRamps next (const SmooshCurve& curve, int numSamples) noexcept;
+
+    // True while any of the values is still moving
+    bool isSmoothing() const noexcept;
+
+    // Settings at the end of the last block
+    const SmooshSettings& getSettings() const noexcept { return smooshSettings; }
+
+private:
+    juce::SmoothedValue<float> smooshSmoothed;
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> inputGainSmoothed;
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> outputGainSmoothed;
+    juce::SmoothedValue<float> mixSmoothed;
+
+    // Smoosh -> compressor settings, looked up only while the knob is moving
+    SmooshSettings smooshSettings;
+
+    // Last dB values seen, so gains are only converted when they change
+    float lastInputGainDB = 0.0f;
+    float lastOutputGainDB = 0.0f;
+};
@@ -1,6 +1,43 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 
+//==============================================================================
+const juce::Image& KnobLayerCache::getTrack (int width, int height, float scale,
+                                             float rotaryStartAngle, float rotaryEndAngle)
+{
+    for (const auto& entry : entries)
+        if (entry.width == width && entry.height == height && entry.scale == scale
+            && entry.rotaryStartAngle == rotaryStartAngle && entry.rotaryEndAngle == rotaryEndAngle)
+            return entry.image;
+
+    // Rendered at physical pixel size so it stays sharp on high-DPI displays
+    juce::Image image (juce::Image::ARGB,
+                       juce::jmax (1, juce::roundToInt ((float) width * scale)),
+                       juce::jmax (1, juce::roundToInt ((float) height * scale)), true);
+    {
+        juce::Graphics g (image);
+        g.addTransform (juce::AffineTransform::scale (scale));
+
+        auto radius = (float) juce::jmin (width / 2, height / 2) - 4.0f;
+        auto rx = (float) width * 0.5f - radius;
+        auto ry = (float) height * 0.5f - radius;
+        auto rw = radius * 2.0f;
+
+        // The whole background arc; the filled part is drawn over it
+        g.setColour(juce::Colour(0xff404040));
+        juce::Path backgroundArc;
+        backgroundArc.addPieSegment(rx, ry, rw, rw, rotaryStartAngle, rotaryEndAngle, 0.8f);
+        g.fillPath(backgroundArc);
+
+        // Draw the outline
+        g.setColour(juce::Colour(0xff606060));
+        g.drawEllipse(rx, ry, rw, rw, 2.0f);
+    }
+
+    entries.push_back ({ width, height, scale, rotaryStartAngle, rotaryEndAngle, image });
+    return entries.back().image;
+}
+
 //==============================================================================
 // Custom LookAndFeel Implementation
 void GradientSliderLookAndFeel::drawRotarySlider (juce::Graphics& g, int x, int y, int width, int height,
@@ -15,6 +52,11 @@ void GradientSliderLookAndFeel::drawRotarySlider (juce::Graphics& g, int x, int
     auto rw = radius * 2.0f;
     auto angle = rotaryStartAngle + sliderPos * (rotaryEndAngle - rotaryStartAngle);
 
+    // Static layers (background arc and outline) come from the cache
+    const auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    const auto& track = layerCache->getTrack (width, height, scale, rotaryStartAngle, rotaryEndAngle);
+    g.drawImage (track, juce::Rectangle<int> (x, y, width, height).toFloat());
+
     // Interpolate color from green (0) to red (1) based on slider position
     juce::Colour fillColour = juce::Colour::fromHSV(
         juce::jmap(sliderPos, 0.33f, 0.0f),  // Hue: 0.33 (green) to 0.0 (red)
@@ -25,22 +67,12 @@ void GradientSliderLookAndFeel::drawRotarySlider (juce::Graphics& g, int x, int
 
     // Draw the filled arc
     g.setColour(fillColour);
-    juce::Path filledArc;
+    filledArc.clear();
     filledArc.addPieSegment(rx, ry, rw, rw, rotaryStartAngle, angle, 0.8f);
     g.fillPath(filledArc);
 
-    // Draw the background arc (unfilled portion)
-    g.setColour(juce::Colour(0xff404040));
-    juce::Path backgroundArc;
-    backgroundArc.addPieSegment(rx, ry, rw, rw, angle, rotaryEndAngle, 0.8f);
-    g.fillPath(backgroundArc);
-
-    // Draw the outline
-    g.setColour(juce::Colour(0xff606060));
-    g.drawEllipse(rx, ry, rw, rw, 2.0f);
-
     // Draw the pointer
-    juce::Path pointer;
+    pointer.clear();
     auto pointerLength = radius * 0.6f;
     auto pointerThickness = 3.0f;
     pointer.addRectangle(-pointerThickness * 0.5f, -radius, pointerThickness, pointerLength);
@@ -52,11 +84,11 @@ void GradientSliderLookAndFeel::drawRotarySlider (juce::Graphics& g, int x, int
 SmoosherAudioProcessorEditor::SmoosherAudioProcessorEditor (SmoosherAudioProcessor& p)
     : AudioProcessorEditor (&p), audioProcessor (p)
 {
-    // Set window size (with room for preset selector and mix control)
-    setSize (500, 260);
+    // Set window size (with room for preset selector, meters and mix control)
+    setSize (500, 320);
 
-    // Setup factory presets
-    setupPresets();
+    // paint() covers every pixel, so nothing behind the editor needs repainting
+    setOpaque (true);
 
     // Configure preset selector
     presetLabel.setText("PRESET:", juce::dontSendNotification);
@@ -66,8 +98,8 @@ SmoosherAudioProcessorEditor::SmoosherAudioProcessorEditor (SmoosherAudioProcess
     addAndMakeVisible(presetLabel);
 
     presetComboBox.addItem("-- Init --", 1);
-    for (int i = 0; i < factoryPresets.size(); ++i)
-        presetComboBox.addItem(factoryPresets[i].name, i + 2);
+    for (int i = 0; i < (int) factoryPresets.size(); ++i)
+        presetComboBox.addItem(factoryPresets[(size_t) i].name, i + 2);
 
     presetComboBox.setSelectedId(1, juce::dontSendNotification);
     presetComboBox.onChange = [this] {
@@ -105,7 +137,7 @@ SmoosherAudioProcessorEditor::SmoosherAudioProcessorEditor (SmoosherAudioProcess
     smooshLabel.setInterceptsMouseClicks(false, false);
     addAndMakeVisible(smooshLabel);
 
-    smooshAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+    smooshAttachment = std::make_unique<ThrottledSliderAttachment>(
         audioProcessor.getAPVTS(), "smoosh", smooshSlider);
 
     // Configure Input Gain slider
@@ -122,7 +154,7 @@ SmoosherAudioProcessorEditor::SmoosherAudioProcessorEditor (SmoosherAudioProcess
     inputGainLabel.setInterceptsMouseClicks(false, false);
     addAndMakeVisible(inputGainLabel);
 
-    inputGainAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+    inputGainAttachment = std::make_unique<ThrottledSliderAttachment>(
         audioProcessor.getAPVTS(), "inputGain", inputGainSlider);
 
     // Configure Output Gain slider
@@ -139,7 +171,7 @@ SmoosherAudioProcessorEditor::SmoosherAudioProcessorEditor (SmoosherAudioProcess
     outputGainLabel.setInterceptsMouseClicks(false, false);
     addAndMakeVisible(outputGainLabel);
 
-    outputGainAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+    outputGainAttachment = std::make_unique<ThrottledSliderAttachment>(
         audioProcessor.getAPVTS(), "outputGain", outputGainSlider);
 
     // Configure Mix slider
@@ -156,18 +188,54 @@ SmoosherAudioProcessorEditor::SmoosherAudioProcessorEditor (SmoosherAudioProcess
     mixLabel.setInterceptsMouseClicks(false, false);
     addAndMakeVisible(mixLabel);
 
-    mixAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+    mixAttachment = std::make_unique<ThrottledSliderAttachment>(
         audioProcessor.getAPVTS(), "mix", mixSlider);
+
+    // Configure channel link toggle (one shared detector for all channels)
+    linkButton.setButtonText("LINK");
+    linkButton.setColour(juce::ToggleButton::textColourId, juce::Colours::white);
+    addAndMakeVisible(linkButton);
+
+    linkAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(
+        audioProcessor.getAPVTS(), "link", linkButton);
+
+    // Configure key source selector (items in the parameter's choice order)
+    keySourceComboBox.addItemList({ "Internal", "Sidechain", "Sidechain Direct" }, 1);
+    keySourceComboBox.setLookAndFeel(&comboBoxLookAndFeel);
+    keySourceComboBox.setColour(juce::ComboBox::textColourId, juce::Colours::white);
+    addAndMakeVisible(keySourceComboBox);
+
+    keySourceAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+        audioProcessor.getAPVTS(), "keySource", keySourceComboBox);
+
+    // Configure multiband selector (items in the parameter's choice order)
+    bandsComboBox.addItemList({ "Off", "2 Bands", "3 Bands" }, 1);
+    bandsComboBox.setLookAndFeel(&comboBoxLookAndFeel);
+    bandsComboBox.setColour(juce::ComboBox::textColourId, juce::Colours::white);
+    addAndMakeVisible(bandsComboBox);
+
+    bandsAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+        audioProcessor.getAPVTS(), "bands", bandsComboBox);
+
+    // Meters. Anything already in the feed was queued while no editor was
+    // open, so drop it rather than show it as live on the first tick.
+    addAndMakeVisible(meterDisplay);
+    audioProcessor.getMeterFeed().discardAll();
+    startTimerHz(MeterDisplay::ticksPerSecond);
 }
 
 SmoosherAudioProcessorEditor::~SmoosherAudioProcessorEditor()
 {
+    stopTimer();
+
     // Clean up LookAndFeel
     smooshSlider.setLookAndFeel(nullptr);
     inputGainSlider.setLookAndFeel(nullptr);
     outputGainSlider.setLookAndFeel(nullptr);
     mixSlider.setLookAndFeel(nullptr);
     presetComboBox.setLookAndFeel(nullptr);
+    keySourceComboBox.setLookAndFeel(nullptr);
+    bandsComboBox.setLookAndFeel(nullptr);
 }
 
 //==============================================================================
@@ -191,8 +259,19 @@ void SmoosherAudioProcessorEditor::resized()
     presetComboBox.setBounds(presetArea.removeFromRight(presetWidth - 65).reduced(5, 0));
     presetLabel.setBounds(presetArea.reduced(0, 0));
 
+    // Link toggle, key source and bands at top left, in line with the preset selector
+    juce::Rectangle<int> detectorArea (bounds.getX(), presetArea.getY(), 230, presetArea.getHeight());
+    linkButton.setBounds(detectorArea.removeFromLeft(60));
+    bandsComboBox.setBounds(detectorArea.removeFromRight(75).reduced(5, 0));
+    keySourceComboBox.setBounds(detectorArea.reduced(5, 0));
+
     bounds.removeFromTop(-5); // Reduced spacing to close gap
 
+    // Meter strip along the bottom, left of the mix control
+    auto meterArea = bounds.removeFromBottom(54);
+    meterArea.removeFromRight(69);
+    meterDisplay.setBounds(meterArea.reduced(0, 4));
+
     // Divide into three equal columns for controls
     int controlWidth = bounds.getWidth() / 3;
 
@@ -222,24 +301,29 @@ void SmoosherAudioProcessorEditor::resized()
 }
 
 //==============================================================================
-void SmoosherAudioProcessorEditor::setupPresets()
+void SmoosherAudioProcessorEditor::timerCallback()
 {
-    // Factory presets
-    // Format: {"Name", Smoosh %, Input dB (0-30), Output/Gain dB (-12 to +12)}
-    factoryPresets.push_back({"Hell Smarsh", 45.0f, 15.0f, 1.0f});
-    factoryPresets.push_back({"Wenger's 7-String", 60.0f, 10.5f, 2.0f});
-    factoryPresets.push_back({"That Joe Sound", 70.0f, 15.0f, 0.0f});
-    factoryPresets.push_back({"Gravy River", 70.0f, 12.0f, 2.0f});
-    factoryPresets.push_back({"Dani Time", 30.0f, 35.0f, 2.0f});
-    factoryPresets.push_back({"Gloopy", 40.0f, 7.5f, 1.0f});
-    factoryPresets.push_back({"Limit THIS!", 75.0f, 24.0f, 3.0f});
+    // Everything the audio thread published since the last tick, reduced to
+    // the loudest values so short peaks between ticks still show up
+    MeterFrame latest;
+
+    audioProcessor.getMeterFeed().popAll([&latest] (const MeterFrame& frame)
+    {
+        latest.inputPeak = juce::jmax(latest.inputPeak, frame.inputPeak);
+        latest.inputRms = juce::jmax(latest.inputRms, frame.inputRms);
+        latest.outputPeak = juce::jmax(latest.outputPeak, frame.outputPeak);
+        latest.gainReductionDb = juce::jmax(latest.gainReductionDb, frame.gainReductionDb);
+    });
+
+    meterDisplay.update(latest);
 }
 
+//==============================================================================
 void SmoosherAudioProcessorEditor::loadPreset(int presetIndex)
 {
-    if (presetIndex >= 0 && presetIndex < factoryPresets.size())
+    if (presetIndex >= 0 && presetIndex < (int) factoryPresets.size())
     {
-        const auto& preset = factoryPresets[presetIndex];
+        const auto& preset = factoryPresets[(size_t) presetIndex];
 
         // Update parameter values
         auto* smooshParam = audioProcessor.getAPVTS().getRawParameterValue("smoosh");
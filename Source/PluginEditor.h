@@ -2,8 +2,31 @@
 
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "FactoryPresets.h"
+#include "MeterDisplay.h"
+#include "ThrottledSliderAttachment.h"
 
 //==============================================================================
+// Pre-rendered static knob layers (track ring and outline), one image per knob
+// size, angle range and display scale. Shared by every open editor through a
+// juce::SharedResourcePointer, so 40 editors render each layer once.
+class KnobLayerCache
+{
+public:
+    const juce::Image& getTrack (int width, int height, float scale,
+                                 float rotaryStartAngle, float rotaryEndAngle);
+
+private:
+    struct Entry
+    {
+        int width, height;
+        float scale, rotaryStartAngle, rotaryEndAngle;
+        juce::Image image;
+    };
+
+    std::vector<Entry> entries;
+};
+
 // Custom LookAndFeel for gradient sliders (green to red)
 class GradientSliderLookAndFeel : public juce::LookAndFeel_V4
 {
@@ -11,6 +34,12 @@ public:
     void drawRotarySlider (juce::Graphics& g, int x, int y, int width, int height,
                           float sliderPos, float rotaryStartAngle, float rotaryEndAngle,
                           juce::Slider& slider) override;
+
+private:
+    juce::SharedResourcePointer<KnobLayerCache> layerCache;
+
+    // Reused between draws so painting doesn't allocate
+    juce::Path filledArc, pointer;
 };
 
 // Custom LookAndFeel for smaller ComboBox font
@@ -29,7 +58,8 @@ public:
 };
 
 //==============================================================================
-class SmoosherAudioProcessorEditor  : public juce::AudioProcessorEditor
+class SmoosherAudioProcessorEditor  : public juce::AudioProcessorEditor,
+                                      private juce::Timer
 {
 public:
     SmoosherAudioProcessorEditor (SmoosherAudioProcessor&);
@@ -40,6 +70,8 @@ public:
     void resized() override;
 
 private:
+    void timerCallback() override;
+
     SmoosherAudioProcessor& audioProcessor;
 
     // Sliders
@@ -58,28 +90,32 @@ private:
     juce::ComboBox presetComboBox;
     juce::Label presetLabel;
 
-    // Attachments
-    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> smooshAttachment;
-    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> inputGainAttachment;
-    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> outputGainAttachment;
-    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> mixAttachment;
+    // Channel link toggle and detector key source
+    juce::ToggleButton linkButton;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> linkAttachment;
+
+    juce::ComboBox keySourceComboBox;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> keySourceAttachment;
+
+    // Multiband mode (the crossover frequencies are host parameters only)
+    juce::ComboBox bandsComboBox;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> bandsAttachment;
+
+    // Attachments (rate-limited, so automation doesn't repaint on every change)
+    std::unique_ptr<ThrottledSliderAttachment> smooshAttachment;
+    std::unique_ptr<ThrottledSliderAttachment> inputGainAttachment;
+    std::unique_ptr<ThrottledSliderAttachment> outputGainAttachment;
+    std::unique_ptr<ThrottledSliderAttachment> mixAttachment;
+
+    // Levels and gain reduction, fed from the processor's MeterFeed
+    MeterDisplay meterDisplay;
 
     // Custom LookAndFeel
     GradientSliderLookAndFeel gradientLookAndFeel;
     SmallComboBoxLookAndFeel comboBoxLookAndFeel;
 
-    // Preset management
-    struct Preset
-    {
-        juce::String name;
-        float smoosh;
-        float inputGain;
-        float outputGain;
-    };
-
-    std::vector<Preset> factoryPresets;
+    // Preset management (see FactoryPresets.h)
     void loadPreset(int presetIndex);
-    void setupPresets();
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SmoosherAudioProcessorEditor)
 };
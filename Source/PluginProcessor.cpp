@@ -8,6 +8,7 @@ SmoosherAudioProcessor::SmoosherAudioProcessor()
                      #if ! JucePlugin_IsMidiEffect
                       #if ! JucePlugin_IsSynth
                        .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
+                       .withInput  ("Sidechain", juce::AudioChannelSet::stereo(), false)
                       #endif
                        .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
                      #endif
@@ -15,6 +16,17 @@ SmoosherAudioProcessor::SmoosherAudioProcessor()
 #endif
     apvts(*this, nullptr, "Parameters", createParameterLayout())
 {
+    // Cache raw parameter pointers so processBlock never looks them up by ID
+    smooshParameter = apvts.getRawParameterValue("smoosh");
+    inputGainParameter = apvts.getRawParameterValue("inputGain");
+    outputGainParameter = apvts.getRawParameterValue("outputGain");
+    mixParameter = apvts.getRawParameterValue("mix");
+    linkParameter = apvts.getRawParameterValue("link");
+    keySourceParameter = apvts.getRawParameterValue("keySource");
+    bandsParameter = apvts.getRawParameterValue("bands");
+    lowCrossoverParameter = apvts.getRawParameterValue("lowCrossover");
+    highCrossoverParameter = apvts.getRawParameterValue("highCrossover");
+    controlRateParameter = apvts.getRawParameterValue("controlRate");
 }
 
 SmoosherAudioProcessor::~SmoosherAudioProcessor()
@@ -70,6 +82,61 @@ juce::AudioProcessorValueTreeState::ParameterLayout SmoosherAudioProcessor::crea
         [](float value, int) { return juce::String(value, 1) + "%"; }
     ));
 
+    // Channel link: one detector and gain computer shared by every channel
+    layout.add(std::make_unique<juce::AudioParameterBool>(
+        "link",
+        "Link",
+        false
+    ));
+
+    // Detector key: the signal itself, or the sidechain bus through the
+    // sibilance high-pass blend, or the sidechain as is (in KeySource order)
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        "keySource",
+        "Key",
+        juce::StringArray { "Internal", "Sidechain", "Sidechain Direct" },
+        0
+    ));
+
+    // Multiband mode: off, or the chain running separately on 2 or 3 bands
+    // (the choice index is the number of bands minus one)
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        "bands",
+        "Bands",
+        juce::StringArray { "Off", "2 Bands", "3 Bands" },
+        0
+    ));
+
+    // Crossover between the low band and the rest (40 Hz to 1 kHz)
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        "lowCrossover",
+        "Low Crossover",
+        juce::NormalisableRange<float>(40.0f, 1000.0f, 1.0f, 0.4f),
+        150.0f,
+        juce::String(),
+        juce::AudioProcessorParameter::genericParameter,
+        [](float value, int) { return juce::String(juce::roundToInt(value)) + " Hz"; }
+    ));
+
+    // Crossover between the mid and high bands in 3-band mode (1 to 12 kHz)
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        "highCrossover",
+        "High Crossover",
+        juce::NormalisableRange<float>(1000.0f, 12000.0f, 1.0f, 0.4f),
+        2500.0f,
+        juce::String(),
+        juce::AudioProcessorParameter::genericParameter,
+        [](float value, int) { return juce::String(value / 1000.0f, 2) + " kHz"; }
+    ));
+
+    // Control-rate gain: the gain computer runs every 4-32 samples (from the
+    // attack time) and the gain is interpolated in between, for less CPU
+    layout.add(std::make_unique<juce::AudioParameterBool>(
+        "controlRate",
+        "Control Rate",
+        false
+    ));
+
     return layout;
 }
 
@@ -108,7 +175,13 @@ bool SmoosherAudioProcessor::isMidiEffect() const
 
 double SmoosherAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    // The longest release, from a full-scale input at maximum input gain
+    return engine.getTailLengthSeconds(apvts.getParameterRange("inputGain").end);
+}
+
+double SmoosherAudioProcessor::getSettlingTimeSeconds() const
+{
+    return engine.getSettlingTimeSeconds(apvts.getParameterRange("inputGain").end);
 }
 
 int SmoosherAudioProcessor::getNumPrograms()
@@ -137,17 +210,59 @@ void SmoosherAudioProcessor::changeProgramName (int index, const juce::String& n
 //==============================================================================
 void SmoosherAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
-    currentSampleRate = sampleRate;
-    envelope.resize(getTotalNumOutputChannels(), 0.0f);
-    hpState1.resize(getTotalNumOutputChannels(), 0.0f);
-    hpState2.resize(getTotalNumOutputChannels(), 0.0f);
-    lpState.resize(getTotalNumOutputChannels(), 0.0f);
+    // State and scratch buffers for the precision the host will call us with
+    // (it's set before prepareToPlay and can't change until the next one),
+    // with every ramp starting at the current parameter values. Offline
+    // bounces (hosts say so before prepareToPlay) spread the channels over
+    // every core; real-time playback stays on the audio thread.
+    const int numThreads = isNonRealtime() ? juce::SystemStats::getNumCpus() : 1;
+
+    engine.setParameters(getEngineParameters());
+    engine.prepare(sampleRate, samplesPerBlock, getTotalNumOutputChannels(), isUsingDoublePrecision(), numThreads);
 }
 
 void SmoosherAudioProcessor::releaseResources()
 {
 }
 
+void SmoosherAudioProcessor::analyseBlock (juce::AudioBuffer<float>& buffer, GainCurve& curve)
+{
+    // The same parameters and key as process(), but nothing is written back
+    engine.setParameters(getEngineParameters());
+
+    const auto keyBuffer = getBusCount(true) > 1 ? getBusBuffer(buffer, true, 1) : juce::AudioBuffer<float>();
+
+    engine.analyse(buffer.getArrayOfReadPointers(), getMainBusNumInputChannels(), buffer.getNumSamples(), curve,
+                   keyBuffer.getArrayOfReadPointers(), keyBuffer.getNumChannels());
+}
+
+void SmoosherAudioProcessor::setGainCurve (const GainCurve* curve)
+{
+    engine.setGainCurve(curve);
+}
+
+SmoosherEngine::Parameters SmoosherAudioProcessor::getEngineParameters() const
+{
+    // Cached atomics, no string lookups on the audio thread
+    SmoosherEngine::Parameters parameters;
+    parameters.smoosh = smooshParameter->load();
+    parameters.inputGainDb = inputGainParameter->load();
+    parameters.outputGainDb = outputGainParameter->load();
+    parameters.mix = mixParameter->load();
+    parameters.link = linkParameter->load() > 0.5f;
+    parameters.keySource = static_cast<KeySource>(juce::roundToInt(keySourceParameter->load()));
+    parameters.numBands = juce::roundToInt(bandsParameter->load()) + 1;
+    parameters.lowCrossoverHz = lowCrossoverParameter->load();
+    parameters.highCrossoverHz = highCrossoverParameter->load();
+    parameters.controlRate = controlRateParameter->load() > 0.5f;
+    return parameters;
+}
+
+bool SmoosherAudioProcessor::supportsDoublePrecisionProcessing() const
+{
+    return true;
+}
+
 #ifndef JucePlugin_PreferredChannelConfigurations
 bool SmoosherAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
 {
@@ -155,8 +270,9 @@ bool SmoosherAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
     juce::ignoreUnused (layouts);
     return true;
   #else
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Any layout works, mono and stereo through surround and discrete, since
+    // every channel runs the same chain
+    if (layouts.getMainOutputChannelSet().isDisabled())
         return false;
 
    #if ! JucePlugin_IsSynth
@@ -164,244 +280,44 @@ bool SmoosherAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
         return false;
    #endif
 
+    // The sidechain bus can be off or any width: channel c keys off sidechain
+    // channel c modulo its channel count, so a mono key drives every channel
     return true;
   #endif
 }
 #endif
 
-void SmoosherAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+void SmoosherAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer&)
+{
+    process(buffer);
+}
+
+void SmoosherAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer&)
 {
-    juce::ScopedNoDenormals noDenormals;
-    auto totalNumInputChannels  = getTotalNumInputChannels();
+    process(buffer);
+}
+
+template <typename SampleType>
+void SmoosherAudioProcessor::process (juce::AudioBuffer<SampleType>& buffer)
+{
+    auto totalNumInputChannels  = getMainBusNumInputChannels(); // the sidechain follows these
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
-    // Get parameter values
-    float smooshAmount = apvts.getRawParameterValue("smoosh")->load();
-    float inputGainDB = apvts.getRawParameterValue("inputGain")->load();
-    float outputGainDB = apvts.getRawParameterValue("outputGain")->load();
-    float mixAmount = apvts.getRawParameterValue("mix")->load() / 100.0f; // Convert to 0-1 range
-
-    // Convert dB to linear gain
-    float inputGain = juce::Decibels::decibelsToGain(inputGainDB);
-    float outputGain = juce::Decibels::decibelsToGain(outputGainDB);
-
-    // Map the single smoosh knob to compressor parameters
-    // Smoosh 0% = no compression, no effect
-    // Smoosh 60% = what was previously 100%
-    // Smoosh 60-100% = EXTRA aggressive "hammer" mode
-    float normalizedSmoosh = smooshAmount / 100.0f;
-
-    // Only process if smoosh is above 0.1%
-    bool compressionActive = smooshAmount > 0.1f;
-
-    // Determine if we're in "hammer" mode (60-100%)
-    bool hammerMode = smooshAmount > 60.0f;
-    float hammerAmount = hammerMode ? (smooshAmount - 60.0f) / 40.0f : 0.0f; // 0-1 for 60-100% range
-
-    // Remap 0-60% to be like old 0-100%
-    float remappedSmoosh = hammerMode ? 1.0f : (normalizedSmoosh / 0.6f);
-
-    // Threshold: starts very high at 0%, goes to -12 dB at 60%, then -6.4 dB at 100%
-    // (Reduced by ~20% for less aggressive compression)
-    float threshold;
-    if (hammerMode)
-    {
-        // In hammer mode: go from -12 dB to -6.4 dB (lower threshold = more compression)
-        threshold = juce::jmap(hammerAmount, -12.0f, -6.4f);
-    }
-    else
-    {
-        // Normal mode: 0 to -12 dB with exponential curve
-        threshold = juce::jmap(remappedSmoosh * remappedSmoosh, 0.0f, -12.0f);
-    }
-
-    // Ratio: 1:1 at 0% → 10:1 at 60% → 16:1 at 100%
-    // (Reduced by ~20% for less aggressive compression)
-    float ratio;
-    if (hammerMode)
-    {
-        // In hammer mode: go from 10:1 to 16:1
-        ratio = juce::jmap(hammerAmount, 10.0f, 16.0f);
-    }
-    else
-    {
-        // Normal mode: 1:1 to 10:1
-        ratio = juce::jmap(remappedSmoosh, 1.0f, 10.0f);
-    }
-
-    // Attack: 10ms at 0% → 3ms at 60% → 1ms at 100% (super fast in hammer mode)
-    float attackMs;
-    if (hammerMode)
-    {
-        // In hammer mode: go from 3ms to 1ms (very fast)
-        attackMs = juce::jmap(hammerAmount, 3.0f, 1.0f);
-    }
-    else
-    {
-        // Normal mode: 10ms to 3ms
-        attackMs = juce::jmap(remappedSmoosh, 10.0f, 3.0f);
-    }
-
-    // Release: 100ms at 0% → 200ms at 60% → 150ms at 100% (slightly faster in hammer mode)
-    float releaseMs;
-    if (hammerMode)
-    {
-        // In hammer mode: go from 200ms to 150ms (faster release for punchiness)
-        releaseMs = juce::jmap(hammerAmount, 200.0f, 150.0f);
-    }
-    else
-    {
-        // Normal mode: 100ms to 200ms
-        releaseMs = juce::jmap(remappedSmoosh, 100.0f, 200.0f);
-    }
-
-    // Calculate attack and release coefficients
-    float attackCoeff = std::exp(-1.0f / (currentSampleRate * attackMs / 1000.0f));
-    float releaseCoeff = std::exp(-1.0f / (currentSampleRate * releaseMs / 1000.0f));
-
-    // Convert threshold to linear
-    float thresholdLinear = juce::Decibels::decibelsToGain(threshold);
-
-    // Makeup gain: 1.0 at 0% → 2.0 at 60% → 2.8 at 100%
-    // (Reduced by ~20% for less aggressive output)
-    float makeupGain;
-    if (hammerMode)
-    {
-        // In hammer mode: 2.0 to 2.8
-        makeupGain = juce::jmap(hammerAmount, 2.0f, 2.8f);
-    }
-    else
-    {
-        // Normal mode: 1.0 to 2.0 with smooth curve
-        makeupGain = 1.0f + (remappedSmoosh * remappedSmoosh * 1.0f);
-    }
-
-    // Saturation: keep it controlled to avoid harsh distortion
-    // 0 at 0% → 0.24 at 60% → 0.28 at 100%
-    // (Reduced by ~20% for less coloration)
-    float saturationAmount;
-    if (hammerMode)
-    {
-        saturationAmount = juce::jmap(hammerAmount, 0.24f, 0.28f);
-    }
-    else
-    {
-        saturationAmount = remappedSmoosh * 0.24f;
-    }
-
-    // Sibilance sensitivity
-    float sibilanceSensitivity = normalizedSmoosh;
-
-    // High-pass filter coefficient for sibilance detection
-    float hpFreq = juce::jmap(normalizedSmoosh, 2000.0f, 5000.0f);
-    float hpCoeff = std::exp(-2.0f * juce::MathConstants<float>::pi * hpFreq / static_cast<float>(currentSampleRate));
-
-    // Low-pass filter: more aggressive in hammer mode to prevent harshness
-    // Normal: 20kHz → 8kHz, Hammer: 8kHz → 6kHz
-    float lpFreq;
-    if (hammerMode)
-    {
-        lpFreq = juce::jmap(hammerAmount, 8000.0f, 6000.0f);
-    }
-    else
-    {
-        lpFreq = juce::jmap(remappedSmoosh, 20000.0f, 8000.0f);
-    }
-    float lpCoeff = std::exp(-2.0f * juce::MathConstants<float>::pi * lpFreq / static_cast<float>(currentSampleRate));
-
-    // Process each channel
-    for (int channel = 0; channel < totalNumInputChannels; ++channel)
-    {
-        auto* channelData = buffer.getWritePointer(channel);
-
-        for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
-        {
-            // Store dry signal for wet/dry mixing
-            float drySample = channelData[sample];
-
-            // Apply input gain
-            float inputSample = channelData[sample] * inputGain;
-
-            float processedSample = inputSample;
-
-            if (compressionActive)
-            {
-                // Apply tube-style saturation (soft clipping with harmonic coloration)
-                if (saturationAmount > 0.001f)
-                {
-                    float saturated = inputSample * (1.0f + saturationAmount);
-                    // Soft clipping with tanh for tube-like saturation
-                    saturated = std::tanh(saturated * 1.5f) / 1.5f;
-                    // Blend between clean and saturated based on saturation amount
-                    processedSample = inputSample + (saturated - inputSample) * saturationAmount * 2.0f;
-                }
-
-                // Low-pass filter to reduce high-frequency harshness
-                lpState[channel] = processedSample * (1.0f - lpCoeff) + lpState[channel] * lpCoeff;
-                processedSample = lpState[channel];
-
-                // High-pass filter for sibilance detection (simple one-pole)
-                float hpSample = processedSample - hpState1[channel];
-                hpState1[channel] = processedSample * (1.0f - hpCoeff) + hpState1[channel] * hpCoeff;
-
-                // Second stage for steeper roll-off
-                float hpSample2 = hpSample - hpState2[channel];
-                hpState2[channel] = hpSample * (1.0f - hpCoeff) + hpState2[channel] * hpCoeff;
-
-                // Blend between full-spectrum and high-passed for sidechain detection
-                float detectionSample = processedSample + (hpSample2 - processedSample) * sibilanceSensitivity;
-
-                // Get absolute value for envelope detection
-                float inputLevel = std::abs(detectionSample);
-
-                // Envelope follower (peak detection)
-                if (inputLevel > envelope[channel])
-                    envelope[channel] = attackCoeff * envelope[channel] + (1.0f - attackCoeff) * inputLevel;
-                else
-                    envelope[channel] = releaseCoeff * envelope[channel] + (1.0f - releaseCoeff) * inputLevel;
-
-                // Calculate gain reduction
-                float gainReduction = 1.0f;
-                if (envelope[channel] > thresholdLinear)
-                {
-                    // Calculate how much we're over the threshold
-                    float overThresholdDB = juce::Decibels::gainToDecibels(envelope[channel] / thresholdLinear);
-
-                    // Apply ratio for compression
-                    float gainReductionDB = overThresholdDB * (1.0f - 1.0f / ratio);
-
-                    // Convert back to linear
-                    gainReduction = juce::Decibels::decibelsToGain(-gainReductionDB);
-                }
-
-                // Apply compression and makeup gain
-                processedSample = processedSample * gainReduction * makeupGain;
-
-                // Soft limiting to prevent harsh clipping in hammer mode
-                if (hammerMode)
-                {
-                    // Soft clip at ±0.95 to prevent hard clipping
-                    float limitThreshold = 0.95f;
-                    if (std::abs(processedSample) > limitThreshold)
-                    {
-                        float sign = processedSample > 0.0f ? 1.0f : -1.0f;
-                        float excess = std::abs(processedSample) - limitThreshold;
-                        // Soft knee limiting
-                        processedSample = sign * (limitThreshold + std::tanh(excess * 2.0f) * 0.05f);
-                    }
-                }
-            }
-
-            // Apply output gain to wet signal
-            float wetSample = processedSample * outputGain;
-
-            // Blend dry and wet signals based on mix amount
-            channelData[sample] = drySample * (1.0f - mixAmount) + wetSample * mixAmount;
-        }
-    }
+    engine.setParameters(getEngineParameters());
+
+    // Hosts switch between bounces and playback without preparing again, and
+    // only bounces may spread the block over the engine's threads
+    engine.setNonRealtime(isNonRealtime());
+
+    // Sidechain key: a view of the host's channels for the second input bus,
+    // which the detector reads from directly
+    const auto keyBuffer = getBusCount(true) > 1 ? getBusBuffer(buffer, true, 1) : juce::AudioBuffer<SampleType>();
+
+    meterFeed.push(engine.process(buffer.getArrayOfWritePointers(), totalNumInputChannels, buffer.getNumSamples(),
+                                  keyBuffer.getArrayOfReadPointers(), keyBuffer.getNumChannels()));
 }
 
 //==============================================================================
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "SmoosherEngine.h"
+#include "MeterFeed.h"
 
 //==============================================================================
 class SmoosherAudioProcessor  : public juce::AudioProcessor
@@ -18,7 +20,10 @@ public:
     bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
    #endif
 
+    // Both precisions run the same templated engine chain
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    bool supportsDoublePrecisionProcessing() const override;
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -47,23 +52,49 @@ public:
     // Parameter getters
     juce::AudioProcessorValueTreeState& getAPVTS() { return apvts; }
 
+    // Per-block levels and gain reduction, for the editor to drain
+    MeterFeed& getMeterFeed() { return meterFeed; }
+
+    // Two-pass offline rendering (see SmoosherEngine::analyse()): the first
+    // pass over a clip, block by block after prepareToPlay, and the finished
+    // curve that processBlock applies in the second (nullptr to go back to
+    // the detector). Not for real-time use.
+    void analyseBlock (juce::AudioBuffer<float>& buffer, GainCurve& curve);
+    void setGainCurve (const GainCurve* curve);
+
+    // Warm-up before rendering a clip apart from the audio before it, so the
+    // state converges on that of one continuous render (within -120 dBFS)
+    double getSettlingTimeSeconds() const;
+
 private:
     //==============================================================================
     juce::AudioProcessorValueTreeState apvts;
     juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
 
-    // Compressor state variables (per channel)
-    std::vector<float> envelope;
-
-    // High-pass filter state for sibilance detection (per channel)
-    std::vector<float> hpState1;
-    std::vector<float> hpState2;
-
-    // Low-pass filter state for high-frequency attenuation (per channel)
-    std::vector<float> lpState;
-
-    // Previous sample rate
-    double currentSampleRate = 44100.0;
+    // The DSP chain, fed from the parameters once per block
+    SmoosherEngine engine;
+
+    // Current parameter values, in the engine's units
+    SmoosherEngine::Parameters getEngineParameters() const;
+
+    // The whole of processBlock, for either precision
+    template <typename SampleType>
+    void process (juce::AudioBuffer<SampleType>& buffer);
+
+    // Cached raw parameter values
+    std::atomic<float>* smooshParameter = nullptr;
+    std::atomic<float>* inputGainParameter = nullptr;
+    std::atomic<float>* outputGainParameter = nullptr;
+    std::atomic<float>* mixParameter = nullptr;
+    std::atomic<float>* linkParameter = nullptr;
+    std::atomic<float>* keySourceParameter = nullptr;
+    std::atomic<float>* bandsParameter = nullptr;
+    std::atomic<float>* lowCrossoverParameter = nullptr;
+    std::atomic<float>* highCrossoverParameter = nullptr;
+    std::atomic<float>* controlRateParameter = nullptr;
+
+    // Metering, published once per processBlock
+    MeterFeed meterFeed;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SmoosherAudioProcessor)
 };
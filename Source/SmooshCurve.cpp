@@ -0,0 +1,209 @@
+#include "SmooshCurve.h"
+#include <juce_audio_basics/juce_audio_basics.h>
+
+//==============================================================================
+void SmooshCurve::prepare (double sampleRate)
+{
+    preparedSampleRate = sampleRate;
+
+    for (int i = 0; i < numPoints; ++i)
+        table[(size_t) i] = calculate (static_cast<float> (i) * stepPercent, sampleRate);
+}
+
+double SmooshCurve::getReleaseTailSeconds (float peakLevelDb) const
+{
+    const auto peakLog2 = std::log2 (juce::Decibels::decibelsToGain ((double) peakLevelDb));
+    double longestSamples = 0.0;
+
+    for (const auto& point : table)
+    {
+        // The envelope falls by a factor of releaseCoeff per sample
+        const auto octavesToThreshold = peakLog2 - (double) point.thresholdLog2;
+        const auto octavesPerSample = -std::log2 ((double) point.releaseCoeff);
+
+        if (octavesToThreshold > 0.0 && octavesPerSample > 0.0)
+            longestSamples = juce::jmax (longestSamples, octavesToThreshold / octavesPerSample);
+    }
+
+    return longestSamples / preparedSampleRate;
+}
+
+double SmooshCurve::getReleaseSeconds (float peakLevelDb, float floorLevelDb) const
+{
+    const auto octaves = (double) (peakLevelDb - floorLevelDb) / 20.0 * std::log2 (10.0);
+    double slowestRelease = 0.0;
+
+    for (const auto& point : table)
+        slowestRelease = juce::jmax (slowestRelease, (double) point.releaseCoeff);
+
+    const auto octavesPerSample = -std::log2 (slowestRelease);
+    return octaves > 0.0 && octavesPerSample > 0.0 ? octaves / octavesPerSample / preparedSampleRate : 0.0;
+}
+
+SmooshSettings SmooshCurve::getSettings (float smooshAmount) const
+{
+    smooshAmount = juce::jlimit (0.0f, 100.0f, smooshAmount);
+
+    auto position = smooshAmount / stepPercent;
+    auto index = juce::jmin (static_cast<int> (position), numPoints - 2);
+    auto frac = position - static_cast<float> (index);
+
+    const auto& a = table[(size_t) index];
+    const auto& b = table[(size_t) index + 1];
+
+    auto lerp = [frac] (float x, float y) { return x + (y - x) * frac; };
+
+    SmooshSettings s;
+
+    // Mode flags come from the real knob position, not the table points
+    s.compressionActive = smooshAmount > 0.1f;
+    s.hammerMode = smooshAmount > 60.0f;
+
+    s.thresholdLog2        = lerp (a.thresholdLog2, b.thresholdLog2);
+    s.ratio                = lerp (a.ratio, b.ratio);
+    s.attackCoeff          = lerp (a.attackCoeff, b.attackCoeff);
+    s.releaseCoeff         = lerp (a.releaseCoeff, b.releaseCoeff);
+    s.makeupGain           = lerp (a.makeupGain, b.makeupGain);
+    s.saturationAmount     = lerp (a.saturationAmount, b.saturationAmount);
+    s.sibilanceSensitivity = lerp (a.sibilanceSensitivity, b.sibilanceSensitivity);
+    s.hpCoeff              = lerp (a.hpCoeff, b.hpCoeff);
+    s.lpCoeff              = lerp (a.lpCoeff, b.lpCoeff);
+
+    // The ratio is linear in the knob position, the slope is not
+    s.compressionSlope = 1.0f - 1.0f / s.ratio;
+
+    return s;
+}
+
+//==============================================================================
+SmooshSettings SmooshCurve::calculate (float smooshAmount, double sampleRate)
+{
+    SmooshSettings s;
+
+    // Map the single smoosh knob to compressor parameters
+    // Smoosh 0% = no compression, no effect
+    // Smoosh 60% = what was previously 100%
+    // Smoosh 60-100% = EXTRA aggressive "hammer" mode
+    float normalizedSmoosh = smooshAmount / 100.0f;
+
+    // Only process if smoosh is above 0.1%
+    s.compressionActive = smooshAmount > 0.1f;
+
+    // Determine if we're in "hammer" mode (60-100%)
+    s.hammerMode = smooshAmount > 60.0f;
+    const bool hammerMode = s.hammerMode;
+    float hammerAmount = hammerMode ? (smooshAmount - 60.0f) / 40.0f : 0.0f; // 0-1 for 60-100% range
+
+    // Remap 0-60% to be like old 0-100%
+    float remappedSmoosh = hammerMode ? 1.0f : (normalizedSmoosh / 0.6f);
+
+    // Threshold: starts very high at 0%, goes to -12 dB at 60%, then -6.4 dB at 100%
+    // (Reduced by ~20% for less aggressive compression)
+    float threshold;
+    if (hammerMode)
+    {
+        // In hammer mode: go from -12 dB to -6.4 dB (lower threshold = more compression)
+        threshold = juce::jmap (hammerAmount, -12.0f, -6.4f);
+    }
+    else
+    {
+        // Normal mode: 0 to -12 dB with exponential curve
+        threshold = juce::jmap (remappedSmoosh * remappedSmoosh, 0.0f, -12.0f);
+    }
+
+    // Ratio: 1:1 at 0% → 10:1 at 60% → 16:1 at 100%
+    // (Reduced by ~20% for less aggressive compression)
+    if (hammerMode)
+    {
+        // In hammer mode: go from 10:1 to 16:1
+        s.ratio = juce::jmap (hammerAmount, 10.0f, 16.0f);
+    }
+    else
+    {
+        // Normal mode: 1:1 to 10:1
+        s.ratio = juce::jmap (remappedSmoosh, 1.0f, 10.0f);
+    }
+
+    // Attack: 10ms at 0% → 3ms at 60% → 1ms at 100% (super fast in hammer mode)
+    float attackMs;
+    if (hammerMode)
+    {
+        // In hammer mode: go from 3ms to 1ms (very fast)
+        attackMs = juce::jmap (hammerAmount, 3.0f, 1.0f);
+    }
+    else
+    {
+        // Normal mode: 10ms to 3ms
+        attackMs = juce::jmap (remappedSmoosh, 10.0f, 3.0f);
+    }
+
+    // Release: 100ms at 0% → 200ms at 60% → 150ms at 100% (slightly faster in hammer mode)
+    float releaseMs;
+    if (hammerMode)
+    {
+        // In hammer mode: go from 200ms to 150ms (faster release for punchiness)
+        releaseMs = juce::jmap (hammerAmount, 200.0f, 150.0f);
+    }
+    else
+    {
+        // Normal mode: 100ms to 200ms
+        releaseMs = juce::jmap (remappedSmoosh, 100.0f, 200.0f);
+    }
+
+    // Calculate attack and release coefficients
+    s.attackCoeff = std::exp (-1.0f / (sampleRate * attackMs / 1000.0f));
+    s.releaseCoeff = std::exp (-1.0f / (sampleRate * releaseMs / 1000.0f));
+
+    // Convert threshold to the log2 domain used by the gain computer
+    s.thresholdLog2 = std::log2 (juce::Decibels::decibelsToGain (threshold));
+
+    // Only the slope of the gain computer depends on the ratio
+    s.compressionSlope = 1.0f - 1.0f / s.ratio;
+
+    // Makeup gain: 1.0 at 0% → 2.0 at 60% → 2.8 at 100%
+    // (Reduced by ~20% for less aggressive output)
+    if (hammerMode)
+    {
+        // In hammer mode: 2.0 to 2.8
+        s.makeupGain = juce::jmap (hammerAmount, 2.0f, 2.8f);
+    }
+    else
+    {
+        // Normal mode: 1.0 to 2.0 with smooth curve
+        s.makeupGain = 1.0f + (remappedSmoosh * remappedSmoosh * 1.0f);
+    }
+
+    // Saturation: keep it controlled to avoid harsh distortion
+    // 0 at 0% → 0.24 at 60% → 0.28 at 100%
+    // (Reduced by ~20% for less coloration)
+    if (hammerMode)
+    {
+        s.saturationAmount = juce::jmap (hammerAmount, 0.24f, 0.28f);
+    }
+    else
+    {
+        s.saturationAmount = remappedSmoosh * 0.24f;
+    }
+
+    // Sibilance sensitivity
+    s.sibilanceSensitivity = normalizedSmoosh;
+
+    // High-pass filter coefficient for sibilance detection
+    float hpFreq = juce::jmap (normalizedSmoosh, 2000.0f, 5000.0f);
+    s.hpCoeff = std::exp (-2.0f * juce::MathConstants<float>::pi * hpFreq / static_cast<float> (sampleRate));
+
+    // Low-pass filter: more aggressive in hammer mode to prevent harshness
+    // Normal: 20kHz → 8kHz, Hammer: 8kHz → 6kHz
+    float lpFreq;
+    if (hammerMode)
+    {
+        lpFreq = juce::jmap (hammerAmount, 8000.0f, 6000.0f);
+    }
+    else
+    {
+        lpFreq = juce::jmap (remappedSmoosh, 20000.0f, 8000.0f);
+    }
+    s.lpCoeff = std::exp (-2.0f * juce::MathConstants<float>::pi * lpFreq / static_cast<float> (sampleRate));
+
+    return s;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <array>
+
+//==============================================================================
+// Everything the DSP needs that is derived from the single Smoosh knob.
+// Values are already converted to the form the inner loop uses (log2
+// threshold, one-pole coefficients, etc.) so nothing has to be re-derived
+// while processing.
+struct SmooshSettings
+{
+    bool compressionActive = false;
+    bool hammerMode = false;
+
+    float thresholdLog2 = 0.0f;         // log2 of the linear threshold
+    float ratio = 1.0f;
+    float compressionSlope = 0.0f;      // 1 - 1/ratio
+    float attackCoeff = 0.0f;
+    float releaseCoeff = 0.0f;
+    float makeupGain = 1.0f;
+    float saturationAmount = 0.0f;
+    float sibilanceSensitivity = 0.0f;
+    float hpCoeff = 0.0f;
+    float lpCoeff = 0.0f;
+
+    // Per-sample increments that take `from` to `to` over numSamples steps.
+    // Only the coefficients are ramped, the mode flags are left at false.
+    static SmooshSettings rampIncrement (const SmooshSettings& from, const SmooshSettings& to, int numSamples) noexcept
+    {
+        const auto scale = 1.0f / static_cast<float> (numSamples);
+        SmooshSettings s;
+        s.thresholdLog2        = (to.thresholdLog2 - from.thresholdLog2) * scale;
+        s.ratio                = (to.ratio - from.ratio) * scale;
+        s.compressionSlope     = (to.compressionSlope - from.compressionSlope) * scale;
+        s.attackCoeff          = (to.attackCoeff - from.attackCoeff) * scale;
+        s.releaseCoeff         = (to.releaseCoeff - from.releaseCoeff) * scale;
+        s.makeupGain           = (to.makeupGain - from.makeupGain) * scale;
+        s.saturationAmount     = (to.saturationAmount - from.saturationAmount) * scale;
+        s.sibilanceSensitivity = (to.sibilanceSensitivity - from.sibilanceSensitivity) * scale;
+        s.hpCoeff              = (to.hpCoeff - from.hpCoeff) * scale;
+        s.lpCoeff              = (to.lpCoeff - from.lpCoeff) * scale;
+        return s;
+    }
+
+    // Advances every coefficient by one ramp increment
+    void advance (const SmooshSettings& increment) noexcept
+    {
+        thresholdLog2        += increment.thresholdLog2;
+        ratio                += increment.ratio;
+        compressionSlope     += increment.compressionSlope;
+        attackCoeff          += increment.attackCoeff;
+        releaseCoeff         += increment.releaseCoeff;
+        makeupGain           += increment.makeupGain;
+        saturationAmount     += increment.saturationAmount;
+        sibilanceSensitivity += increment.sibilanceSensitivity;
+        hpCoeff              += increment.hpCoeff;
+        lpCoeff              += increment.lpCoeff;
+    }
+};
+
+//==============================================================================
+// Precomputed Smoosh -> SmooshSettings table for one sample rate.
+// Built in prepareToPlay, then looked up (with linear interpolation between
+// table points) only when the Smoosh parameter actually changes.
+class SmooshCurve
+{
+public:
+    // Table resolution in Smoosh percent. The 60% hammer breakpoint lies on a
+    // table point, and within each region all curves are smooth enough that
+    // linear interpolation stays below 0.001 dB of threshold and 0.1% of the
+    // attack/release time constants.
+    static constexpr float stepPercent = 0.5f;
+    static constexpr int numPoints = static_cast<int> (100.0f / stepPercent) + 1;
+
+    // Starts out prepared for 44.1 kHz so lookups are valid before the host prepares
+    SmooshCurve() { prepare (44100.0); }
+
+    void prepare (double sampleRate);
+
+    SmooshSettings getSettings (float smooshAmount) const;
+
+    // Longest time, over the whole curve, for the envelope to release from
+    // peakLevelDb down to the compression threshold (after which leftover
+    // envelope no longer changes the gain)
+    double getReleaseTailSeconds (float peakLevelDb) const;
+
+    // Longest time, over the whole curve, for the envelope to release from
+    // peakLevelDb down to floorLevelDb
+    double getReleaseSeconds (float peakLevelDb, float floorLevelDb) const;
+
+    // Exact (non-tabulated) mapping, as the processor used to compute it every block
+    static SmooshSettings calculate (float smooshAmount, double sampleRate);
+
+private:
+    std::array<SmooshSettings, numPoints> table;
+    double preparedSampleRate = 0.0;
+};
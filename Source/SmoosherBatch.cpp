@@ -0,0 +1,221 @@
+#include "SmoosherBatch.h"
+
+//==============================================================================
+void SmoosherBatch::LaneValues::prepare (int width)
+{
+    start.assign ((size_t) width, 0.0f);
+    increment.assign ((size_t) width, 0.0f);
+}
+
+void SmoosherBatch::LaneValues::set (int firstLane, int numLanes, DSPKernels::Ramp ramp) noexcept
+{
+    std::fill_n (start.begin() + firstLane, numLanes, ramp.start);
+    std::fill_n (increment.begin() + firstLane, numLanes, ramp.increment);
+}
+
+//==============================================================================
+void SmoosherBatch::prepare (double sampleRate, int newMaxBlockSize, int newNumStreams, int newNumChannelsPerStream, int numWorkers)
+{
+    constexpr int maxGroupWidth = Lanes::maxRegisters * Lanes::laneWidth;
+    jassert (newNumChannelsPerStream > 0 && newNumChannelsPerStream <= maxGroupWidth);
+
+    numStreams = juce::jmax (0, newNumStreams);
+    numChannelsPerStream = juce::jlimit (1, maxGroupWidth, newNumChannelsPerStream);
+    maxBlockSize = juce::jmax (1, newMaxBlockSize);
+    currentSampleRate = sampleRate;
+
+    smooshCurve.prepare (sampleRate);
+
+    // Pick the kernel instruction set here rather than on the processing threads
+    DSPKernels::getInstructionSet();
+
+    // The narrowest groups that hold every stream, so a handful of streams
+    // doesn't run in half-empty 16-channel groups
+    const int registers = Lanes::getRegistersFor (juce::jmax (1, numStreams) * numChannelsPerStream);
+    const int width = registers * Lanes::laneWidth;
+    streamsPerGroup = width / numChannelsPerStream;
+
+    parameters.resize ((size_t) numStreams);
+    groups.clear();
+
+    for (int firstStream = 0; firstStream < numStreams; firstStream += streamsPerGroup)
+    {
+        Group group;
+        group.lanes = Lanes (registers);
+        group.firstStream = firstStream;
+        group.numStreams = juce::jmin (streamsPerGroup, numStreams - firstStream);
+        group.smoothing.resize ((size_t) group.numStreams);
+
+        for (int i = 0; i < group.numStreams; ++i)
+        {
+            const auto& p = parameters[(size_t) (firstStream + i)];
+            auto& smoothing = group.smoothing[(size_t) i];
+            smoothing.setTargets (p.smoosh, p.inputGainDb, p.outputGainDb, p.mix);
+            smoothing.reset (smooshCurve, sampleRate);
+        }
+
+        groups.push_back (std::move (group));
+    }
+
+    scratch.resize ((size_t) juce::jmax (1, numWorkers));
+
+    for (auto& s : scratch)
+    {
+        const auto numFrames = (size_t) (maxBlockSize * registers);
+        s.dryFrames.resize (numFrames);
+        s.wetFrames.resize (numFrames);
+        s.envelopeFrames.resize (numFrames);
+        s.channels.assign ((size_t) width, nullptr);
+
+        for (auto* values : { &s.inputGain, &s.outputGain, &s.mix, &s.makeupGain,
+                              &s.saturation, &s.thresholdLog2, &s.compressionSlope })
+            values->prepare (width);
+
+        s.coefficients = {};
+        s.coefficientIncrement = {};
+        s.limit.reset (new bool[(size_t) width]());
+    }
+}
+
+void SmoosherBatch::release()
+{
+    groups = std::vector<Group>();
+    scratch = std::vector<Scratch>();
+}
+
+void SmoosherBatch::setParameters (int stream, const Parameters& newParameters) noexcept
+{
+    jassert (stream >= 0 && stream < numStreams); // prepare() sets the number of streams
+    if (stream < 0 || stream >= numStreams)
+        return;
+
+    parameters[(size_t) stream] = newParameters;
+
+    auto& group = groups[(size_t) (stream / streamsPerGroup)];
+    group.smoothing[(size_t) (stream % streamsPerGroup)].setTargets (newParameters.smoosh, newParameters.inputGainDb,
+                                                                     newParameters.outputGainDb, newParameters.mix);
+}
+
+void SmoosherBatch::resetStream (int stream) noexcept
+{
+    jassert (stream >= 0 && stream < numStreams);
+    if (stream < 0 || stream >= numStreams)
+        return;
+
+    auto& group = groups[(size_t) (stream / streamsPerGroup)];
+    const int streamInGroup = stream % streamsPerGroup;
+
+    group.smoothing[(size_t) streamInGroup].reset (smooshCurve, currentSampleRate);
+    group.lanes.resetLanes (streamInGroup * numChannelsPerStream, numChannelsPerStream);
+}
+
+//==============================================================================
+void SmoosherBatch::process (float* const* channels, int numSamples) noexcept
+{
+    processGroups (0, 0, getNumGroups(), channels, numSamples);
+}
+
+void SmoosherBatch::processGroups (int worker, int firstGroup, int numGroups, float* const* channels, int numSamples) noexcept
+{
+    juce::ScopedNoDenormals noDenormals;
+
+    jassert (worker >= 0 && worker < (int) scratch.size());
+    jassert (firstGroup >= 0 && firstGroup + numGroups <= getNumGroups());
+
+    auto& workerScratch = scratch[(size_t) worker];
+
+    // Each group goes through the whole block before the next one, so its
+    // state and scratch frames stay in cache
+    for (int g = firstGroup; g < firstGroup + numGroups; ++g)
+        for (int startSample = 0; startSample < numSamples; startSample += maxBlockSize)
+            processGroup (groups[(size_t) g], workerScratch, channels, startSample, juce::jmin (maxBlockSize, numSamples - startSample));
+}
+
+void SmoosherBatch::processGroup (Group& group, Scratch& s, float* const* channels, int startSample, int numSamples) noexcept
+{
+    const int width = group.lanes.getWidth();
+    const int numLanes = group.numStreams * numChannelsPerStream;
+
+    // Ramps for every stream. The stages only run if some stream in the group
+    // needs them; in the others they pass the signal through unchanged.
+    bool compress = false, saturate = false;
+
+    for (int i = 0; i < group.numStreams; ++i)
+    {
+        const auto ramps = group.smoothing[(size_t) i].next (smooshCurve, numSamples);
+        setLaneRamps (s, i * numChannelsPerStream, ramps);
+
+        compress = compress || ramps.compressionActive;
+        saturate = saturate || (ramps.compressionActive && ramps.saturationActive);
+    }
+
+    for (int lane = 0; lane < numLanes; ++lane)
+        s.channels[(size_t) lane] = channels[group.firstStream * numChannelsPerStream + lane] + startSample;
+
+    auto* dry = reinterpret_cast<float*> (s.dryFrames.data());
+    auto* wet = reinterpret_cast<float*> (s.wetFrames.data());
+    auto* envelope = reinterpret_cast<float*> (s.envelopeFrames.data());
+
+    Lanes::interleave (s.channels.data(), numLanes, s.dryFrames.data(), width, numSamples);
+
+    // Stage 1: input gain
+    DSPKernels::applyLaneGain (wet, dry, numSamples, width, s.inputGain.get());
+
+    if (compress)
+    {
+        // Stage 2: tube-style saturation
+        if (saturate)
+            DSPKernels::saturateLanes (wet, numSamples, width, s.saturation.get());
+
+        // Stages 3-4: low-pass, sibilance detection, envelope follower and gain computer
+        group.lanes.processLanes (s.wetFrames.data(), s.envelopeFrames.data(), numSamples, s.coefficients, s.coefficientIncrement);
+
+        DSPKernels::applyLaneGainComputer (wet, envelope, numSamples, width, s.thresholdLog2.get(), s.compressionSlope.get());
+    }
+
+    // Stages 5-6: makeup gain, soft limiting in hammer mode, output gain and dry/wet mix
+    DSPKernels::mixDryWetLanes (dry, dry, wet, numSamples, width, s.makeupGain.get(), s.outputGain.get(), s.mix.get(), s.limit.get());
+
+    Lanes::deinterleave (s.dryFrames.data(), s.channels.data(), numLanes, width, numSamples);
+}
+
+void SmoosherBatch::setLaneRamps (Scratch& s, int firstLane, const BlockRamps& ramps) const noexcept
+{
+    constexpr DSPKernels::Ramp off { 0.0f, 0.0f };
+    constexpr DSPKernels::Ramp unity { 1.0f, 0.0f };
+
+    const auto& settings = ramps.settings;
+    const auto& increment = ramps.increment;
+    const bool compress = ramps.compressionActive;
+    const int numLanes = numChannelsPerStream;
+
+    s.inputGain.set (firstLane, numLanes, ramps.inputGain);
+    s.outputGain.set (firstLane, numLanes, ramps.outputGain);
+    s.mix.set (firstLane, numLanes, ramps.mix);
+
+    // Without compression: no saturation, no low-pass (a coefficient of 0
+    // passes the signal as is), unity gain (a slope of 0 gives exactly 1)
+    // and no makeup or limiting, as in SmoosherEngine's bypass chain
+    s.makeupGain.set (firstLane, numLanes, compress ? DSPKernels::Ramp { settings.makeupGain, increment.makeupGain } : unity);
+    s.saturation.set (firstLane, numLanes, compress && ramps.saturationActive ? DSPKernels::Ramp { settings.saturationAmount, increment.saturationAmount } : off);
+    s.thresholdLog2.set (firstLane, numLanes, { settings.thresholdLog2, increment.thresholdLog2 });
+    s.compressionSlope.set (firstLane, numLanes, compress ? DSPKernels::Ramp { settings.compressionSlope, increment.compressionSlope } : off);
+
+    auto setCoefficient = [&] (auto member, float start, float perSample)
+    {
+        auto* starts = reinterpret_cast<float*> ((s.coefficients.*member).data());
+        auto* increments = reinterpret_cast<float*> ((s.coefficientIncrement.*member).data());
+
+        std::fill_n (starts + firstLane, numLanes, start);
+        std::fill_n (increments + firstLane, numLanes, perSample);
+    };
+
+    using Coefficients = Lanes::LaneCoefficients;
+    setCoefficient (&Coefficients::lpCoeff, compress ? settings.lpCoeff : 0.0f, compress ? increment.lpCoeff : 0.0f);
+    setCoefficient (&Coefficients::hpCoeff, settings.hpCoeff, increment.hpCoeff);
+    setCoefficient (&Coefficients::attackCoeff, settings.attackCoeff, increment.attackCoeff);
+    setCoefficient (&Coefficients::releaseCoeff, settings.releaseCoeff, increment.releaseCoeff);
+    setCoefficient (&Coefficients::sibilanceSensitivity, settings.sibilanceSensitivity, increment.sibilanceSensitivity);
+
+    std::fill_n (s.limit.get() + firstLane, numLanes, compress && ramps.hammerMode);
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "SmoosherEngine.h"
+
+//==============================================================================
+// Many independent Smoosher streams (one per incoming feed in a server, say)
+// processed side by side, with the SIMD lanes spanning streams rather than
+// the channels of a single one.
+//
+// Every stream has its own smoosh, gain and mix settings and its own filter
+// and envelope state. The state of all streams is a structure of arrays in
+// lane groups of up to 16 channels (SSE/NEON float): eight stereo streams
+// share one pass of the recursive stages, whose independent registers overlap
+// in the pipeline, and the block kernels run at full vector width with a ramp
+// per lane. Each lane computes what SmoosherEngine would for that channel, up
+// to the detector state carried across a switch into or out of compression.
+//
+// Streams all have the same channel count and use the per-channel detector
+// on their own signal: link, the sidechain key and multiband mode are only
+// in SmoosherEngine. Float only.
+//
+// prepare() allocates everything; setParameters() and processGroups() never
+// allocate, lock or block. Worker threads may run processGroups() at the
+// same time for disjoint ranges of groups, each with its own worker index,
+// as long as nothing calls setParameters() for a stream in a group while
+// that group is being processed.
+class SmoosherBatch
+{
+public:
+    // Only smoosh, the gains and mix are used
+    using Parameters = SmoosherEngine::Parameters;
+
+    SmoosherBatch() = default;
+
+    // Allocates the state of numStreams streams of numChannelsPerStream
+    // channels each (at most 16 with SSE/NEON), and scratch buffers for
+    // numWorkers threads. Every stream starts at its parameters without a
+    // ramp: the ones last set if it existed before, the defaults otherwise.
+    void prepare (double sampleRate, int maxBlockSize, int numStreams, int numChannelsPerStream, int numWorkers = 1);
+
+    // Frees everything until the next prepare()
+    void release();
+
+    int getNumStreams() const noexcept                { return numStreams; }
+    int getNumChannelsPerStream() const noexcept      { return numChannelsPerStream; }
+
+    // Streams are processed in groups of getStreamsPerGroup(); group g holds
+    // streams g * getStreamsPerGroup() onwards
+    int getNumGroups() const noexcept                 { return (int) groups.size(); }
+    int getStreamsPerGroup() const noexcept           { return streamsPerGroup; }
+
+    // New targets for a stream's next block. Gains, smoosh and mix ramp to
+    // them like they do in SmoosherEngine.
+    void setParameters (int stream, const Parameters& newParameters) noexcept;
+
+    // Jumps a stream's ramps straight to its parameters and clears its filter
+    // and envelope state, for a stream that starts on a new feed
+    void resetStream (int stream) noexcept;
+
+    // Processes numSamples samples of every stream in place. Channel c of
+    // stream s is channels[s * getNumChannelsPerStream() + c]. Any number of
+    // samples works (longer blocks are split internally).
+    void process (float* const* channels, int numSamples) noexcept;
+
+    // Same for groups firstGroup to firstGroup + numGroups - 1 only, using the
+    // scratch buffers of `worker` (0 to numWorkers - 1). `channels` is
+    // indexed the same way as for process().
+    void processGroups (int worker, int firstGroup, int numGroups, float* const* channels, int numSamples) noexcept;
+
+private:
+    using Lanes = ChannelLanes<float>;
+
+    // One lane group: the filter and envelope state of its streams' channels
+    // and their parameter smoothing
+    struct Group
+    {
+        Lanes lanes;
+        int firstStream = 0;
+        int numStreams = 0;
+        std::vector<ParameterRamps> smoothing;
+    };
+
+    // A value per lane (start and per-sample increment) for one block
+    struct LaneValues
+    {
+        std::vector<float> start, increment;
+
+        void prepare (int width);
+        void set (int firstLane, int numLanes, DSPKernels::Ramp ramp) noexcept;
+        DSPKernels::LaneRamps get() const noexcept { return { start.data(), increment.data() }; }
+    };
+
+    // Scratch buffers for one worker thread
+    struct Scratch
+    {
+        // Interleaved dry signal (which the output replaces), wet signal and
+        // envelope, and the group's channels at the current sample
+        std::vector<Lanes::Lanes> dryFrames, wetFrames, envelopeFrames;
+        std::vector<float*> channels;
+
+        // Every ramped value, per lane, and the lanes in hammer mode
+        LaneValues inputGain, outputGain, mix, makeupGain, saturation, thresholdLog2, compressionSlope;
+        Lanes::LaneCoefficients coefficients, coefficientIncrement;
+        std::unique_ptr<bool[]> limit;
+    };
+
+    void processGroup (Group& group, Scratch& scratch, float* const* channels, int startSample, int numSamples) noexcept;
+
+    // Writes one stream's ramps for a block into its lanes, with the stages
+    // SmoosherEngine would skip for it set to pass the signal through
+    void setLaneRamps (Scratch& scratch, int firstLane, const BlockRamps& ramps) const noexcept;
+
+    double currentSampleRate = 44100.0;
+    SmooshCurve smooshCurve;
+    std::vector<Parameters> parameters;
+    std::vector<Group> groups;
+    std::vector<Scratch> scratch;
+
+    int numStreams = 0;
+    int numChannelsPerStream = 0;
+    int streamsPerGroup = 0;
+    int maxBlockSize = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SmoosherBatch)
+};
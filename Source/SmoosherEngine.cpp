@@ -0,0 +1,917 @@
+#include "SmoosherEngine.h"
+#include "FastMath.h"
+
+//==============================================================================
+class SmoosherEngine::SliceJob  : public juce::ThreadPoolJob
+{
+public:
+    SliceJob() : juce::ThreadPoolJob ("Smoosher slice") {}
+
+    // Set for each block: the slice and how to run it
+    void (*run) (void*) = nullptr;
+    void* slice = nullptr;
+
+    JobStatus runJob() override
+    {
+        juce::ScopedNoDenormals noDenormals;
+        run (slice);
+        return jobHasFinished;
+    }
+};
+
+SmoosherEngine::SmoosherEngine() = default;
+SmoosherEngine::~SmoosherEngine() = default;
+
+//==============================================================================
+void SmoosherEngine::prepare (double sampleRate, int maxBlockSize, int numChannels, bool useDoublePrecision, int numThreads)
+{
+    currentSampleRate = sampleRate;
+    numThreads = juce::jmax (1, numThreads);
+
+    // State and scratch buffers for the precision process() will be called
+    // with (hosts set it before prepareToPlay and can't change it until the next one)
+    if (useDoublePrecision)
+    {
+        doubleChain.prepare (numChannels, maxBlockSize, numThreads);
+        floatChain.release();
+    }
+    else
+    {
+        floatChain.prepare (numChannels, maxBlockSize, numThreads);
+        doubleChain.release();
+    }
+
+    // A pool thread and a job for every slice but the first, which runs on
+    // the calling thread
+    const auto numSlices = juce::jmax (floatChain.slices.size(), doubleChain.slices.size());
+    const int numPoolThreads = (int) numSlices - 1;
+
+    if (numPoolThreads <= 0)
+    {
+        threadPool.reset();
+        sliceJobs.clear();
+    }
+    else if (threadPool == nullptr || threadPool->getNumThreads() != numPoolThreads)
+    {
+        threadPool.reset();
+        threadPool = std::make_unique<juce::ThreadPool> (numPoolThreads);
+
+        sliceJobs.clear();
+        for (int i = 0; i < numPoolThreads; ++i)
+            sliceJobs.push_back (std::make_unique<SliceJob>());
+    }
+
+    // Rebuild the smoosh curve for this sample rate
+    smooshCurve.prepare (sampleRate);
+
+    // Pick the kernel instruction set here rather than on the audio thread
+    DSPKernels::getInstructionSet();
+
+    // Start every smoother at the current parameter value so playback
+    // doesn't begin with a ramp
+    smoothing.setTargets (parameters.smoosh, parameters.inputGainDb, parameters.outputGainDb, parameters.mix);
+    smoothing.reset (smooshCurve, sampleRate);
+
+    gainCurvePosition = 0;
+}
+
+void SmoosherEngine::release()
+{
+    floatChain.release();
+    doubleChain.release();
+    threadPool.reset();
+    sliceJobs.clear();
+}
+
+void SmoosherEngine::setParameters (const Parameters& newParameters) noexcept
+{
+    parameters = newParameters;
+    smoothing.setTargets (parameters.smoosh, parameters.inputGainDb, parameters.outputGainDb, parameters.mix);
+}
+
+void SmoosherEngine::setGainCurve (const GainCurve* curve) noexcept
+{
+    jassert (curve == nullptr || curve->isFinished()); // finish() it after the first pass
+    gainCurve = curve != nullptr && curve->isFinished() ? curve : nullptr;
+    gainCurvePosition = 0;
+}
+
+double SmoosherEngine::getTailLengthSeconds (float maxInputGainDb) const
+{
+    // The audible tail is only the low-pass ringing out, but the envelope keeps
+    // releasing after the input stops, and a host that suspends the plugin
+    // before it has fallen below threshold would apply stale gain reduction to
+    // whatever comes next. The loudest the detector sees is a full-scale input
+    // at maximum input gain.
+    return smooshCurve.getReleaseTailSeconds (maxInputGainDb);
+}
+
+double SmoosherEngine::getSettlingTimeSeconds (float maxInputGainDb) const
+{
+    // Every sample the envelope closes at least (1 - releaseCoeff) of its gap
+    // to the input (attacking closes more), so the gap between two envelopes
+    // following the same input shrinks by at least releaseCoeff
+    return smooshCurve.getReleaseSeconds (maxInputGainDb, settledLevelDb);
+}
+
+//==============================================================================
+template <typename SampleType>
+void SmoosherEngine::ChainState<SampleType>::prepare (int numChannels, int maxBlockSize, int numThreads)
+{
+    // Filter and envelope state, one SIMD lane per channel, in groups as wide
+    // as the layout needs (so a 7.1.4 bed is one 16-channel group in float).
+    // On several threads, groups no wider than each thread's share of the
+    // channels, so there are enough to go round.
+    using Lanes = ChannelLanes<SampleType>;
+    constexpr int maxBands = Crossover<SampleType>::maxBands;
+
+    auto makeLaneGroups = [] (int channels, int channelsPerGroup)
+    {
+        const int registersPerGroup = Lanes::getRegistersFor (channelsPerGroup);
+        const int groupWidth = registersPerGroup * Lanes::laneWidth;
+        return std::vector<Lanes> ((size_t) ((channels + groupWidth - 1) / groupWidth), Lanes (registersPerGroup));
+    };
+
+    numMainChannels = numChannels;
+    channelLanes = makeLaneGroups (numChannels, (numChannels + numThreads - 1) / numThreads);
+
+    // Multiband state is allocated up front too, so the bands can be switched
+    // on while playing
+    numBands = 1;
+    bandLanes = makeLaneGroups (numChannels * maxBands, numChannels * maxBands);
+    crossovers.assign ((size_t) ((numChannels + Lanes::laneWidth - 1) / Lanes::laneWidth), {});
+    lowCrossoverHz = highCrossoverHz = 0.0f; // recalculated on the first block
+
+    // Scratch buffer for the wet signal chain. The band lane groups are never
+    // narrower than the plain ones, so their frames fit either.
+    wetBuffer.setSize (numChannels * maxBands, juce::jmax (1, maxBlockSize));
+    const auto numFrames = (size_t) wetBuffer.getNumSamples();
+    const auto maxRegisters = (size_t) Lanes::getRegistersFor (numChannels * maxBands);
+    laneFrames.resize (numFrames * maxRegisters);
+    envelopeFrames.resize (numFrames * maxRegisters);
+    bandFrames.resize (numFrames * maxBands);
+    const auto controlFramesPerGroup = 2 * (numFrames / minControlRate + 2) * maxRegisters;
+    controlFrames.resize (controlFramesPerGroup);
+    linkedEnvelopeFrames.resize (numFrames * maxBands);
+    linkedGainFrames.resize (numFrames * maxBands);
+    linkedEnvelope = {};
+
+    keyChannels.assign ((size_t) (numChannels * maxBands), nullptr);
+
+    // Parallel mode: the lane groups split into one contiguous run per thread
+    const int numGroups = (int) channelLanes.size();
+    const int numSlices = juce::jmin (numThreads, numGroups);
+    slices.clear();
+    sliceFrames.clear();
+
+    if (numSlices > 1)
+    {
+        const int groupWidth = channelLanes.front().getWidth();
+        const auto registersPerGroup = (size_t) (groupWidth / Lanes::laneWidth);
+        const auto framesPerSlice = numFrames * registersPerGroup;
+        const auto controlFramesPerSlice = 2 * (numFrames / minControlRate + 2) * registersPerGroup;
+        const auto sliceStride = framesPerSlice * 2 + controlFramesPerSlice;
+        sliceFrames.resize (sliceStride * (size_t) (numSlices - 1));
+
+        for (int i = 0; i < numSlices; ++i)
+        {
+            ChainSlice<SampleType> slice;
+            slice.firstGroup = i * numGroups / numSlices;
+            slice.firstChannel = slice.firstGroup * groupWidth;
+            slice.endChannel = juce::jmin (numChannels, (i + 1) * numGroups / numSlices * groupWidth);
+
+            if (i == 0)
+            {
+                slice.laneFrames = laneFrames.data();
+                slice.envelopeFrames = envelopeFrames.data();
+                slice.controlFrames = controlFrames.data();
+            }
+            else
+            {
+                slice.laneFrames = sliceFrames.data() + sliceStride * (size_t) (i - 1);
+                slice.envelopeFrames = slice.laneFrames + framesPerSlice;
+                slice.controlFrames = slice.envelopeFrames + framesPerSlice;
+            }
+
+            slices.push_back (slice);
+        }
+    }
+}
+
+template <typename SampleType>
+void SmoosherEngine::ChainState<SampleType>::release()
+{
+    *this = {};
+}
+
+template <typename SampleType>
+SmoosherEngine::ChainState<SampleType>& SmoosherEngine::getChainState() noexcept
+{
+    if constexpr (std::is_same_v<SampleType, double>)
+        return doubleChain;
+    else
+        return floatChain;
+}
+
+MeterFrame SmoosherEngine::process (float* const* channels, int numChannels, int numSamples,
+                                    const float* const* keyChannels, int numKeyChannels) noexcept
+{
+    return processBlock (channels, numChannels, numSamples, keyChannels, numKeyChannels);
+}
+
+MeterFrame SmoosherEngine::process (double* const* channels, int numChannels, int numSamples,
+                                    const double* const* keyChannels, int numKeyChannels) noexcept
+{
+    return processBlock (channels, numChannels, numSamples, keyChannels, numKeyChannels);
+}
+
+void SmoosherEngine::analyse (const float* const* channels, int numChannels, int numSamples, GainCurve& curve,
+                              const float* const* keyChannels, int numKeyChannels) noexcept
+{
+    // The channels are only read while recording
+    recordingCurve = &curve;
+    processBlock (const_cast<float* const*> (channels), numChannels, numSamples, keyChannels, numKeyChannels);
+    recordingCurve = nullptr;
+}
+
+void SmoosherEngine::analyse (const double* const* channels, int numChannels, int numSamples, GainCurve& curve,
+                              const double* const* keyChannels, int numKeyChannels) noexcept
+{
+    recordingCurve = &curve;
+    processBlock (const_cast<double* const*> (channels), numChannels, numSamples, keyChannels, numKeyChannels);
+    recordingCurve = nullptr;
+}
+
+template <typename SampleType>
+MeterFrame SmoosherEngine::processBlock (SampleType* const* channels, int numChannelsIn, int numSamples,
+                                         const SampleType* const* keyChannels, int numKeyChannels) noexcept
+{
+    juce::ScopedNoDenormals noDenormals;
+
+    auto& chain = getChainState<SampleType>();
+    const int numChannels = juce::jmin (numChannelsIn, chain.numMainChannels);
+
+    // Multiband mode. The bands have different filter and envelope state from
+    // the single band, so whichever set is switched to starts from silence.
+    const int numBands = juce::jlimit (1, Crossover<SampleType>::maxBands, parameters.numBands);
+    if (numBands != chain.numBands)
+    {
+        chain.numBands = numBands;
+
+        for (auto& lanes : chain.getLanes())
+            lanes.reset();
+
+        for (auto& crossover : chain.crossovers)
+            crossover.reset();
+
+        chain.linkedEnvelope = {};
+    }
+
+    if (numBands > 1)
+    {
+        const float lowHz = parameters.lowCrossoverHz;
+        const float highHz = parameters.highCrossoverHz;
+
+        if (lowHz != chain.lowCrossoverHz || highHz != chain.highCrossoverHz)
+        {
+            chain.lowCrossover = Crossover<SampleType>::makeCoefficients (lowHz, currentSampleRate);
+            chain.highCrossover = Crossover<SampleType>::makeCoefficients (highHz, currentSampleRate);
+            chain.lowCrossoverHz = lowHz;
+            chain.highCrossoverHz = highHz;
+        }
+    }
+
+    // Linking only means something with more than one channel. On a switch,
+    // carry the envelope over so the gain doesn't jump.
+    const bool link = parameters.link && numChannels > 1;
+    if (link != chain.linked)
+    {
+        if (link)
+        {
+            SampleType loudest = 0;
+            for (const auto& lanes : chain.getLanes())
+                loudest = juce::jmax (loudest, lanes.getMaxEnvelope());
+
+            chain.linkedEnvelope.fill (loudest);
+        }
+        else
+        {
+            const auto loudest = *std::max_element (chain.linkedEnvelope.begin(), chain.linkedEnvelope.end());
+
+            for (auto& lanes : chain.getLanes())
+                lanes.setEnvelope (loudest);
+        }
+
+        chain.linked = link;
+    }
+
+    // Sidechain key, which the detector reads from the caller's channels
+    // directly. Without one, use the signal itself.
+    if (keyChannels == nullptr)
+        numKeyChannels = 0;
+
+    chain.keySource = numKeyChannels > 0 ? parameters.keySource : KeySource::internal;
+
+    // Input levels for the meters, also used to detect silence
+    MeterFrame meter;
+    const int maxChunk = chain.wetBuffer.getNumSamples();
+    jassert (maxChunk > 0); // prepare() hasn't been called
+    if (maxChunk == 0)
+        return meter;
+
+    float inputSumOfSquares = 0.0f;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        const auto levels = DSPKernels::measureLevels (channels[channel], numSamples);
+        meter.inputPeak = juce::jmax (meter.inputPeak, levels.peak);
+        inputSumOfSquares += levels.sumOfSquares;
+    }
+
+    if (numChannels > 0 && numSamples > 0)
+        meter.inputRms = std::sqrt (inputSumOfSquares / static_cast<float> (numChannels * numSamples));
+
+    // Idle mode: with silent input and every filter and envelope decayed the
+    // output is silent too, so skip the chain and just clear the buffer. A
+    // sidechain key has to be silent as well: it keeps driving the detector,
+    // so whatever comes in next is ducked from its first sample.
+    float idlePeak = meter.inputPeak;
+
+    if (chain.keySource != KeySource::internal)
+        for (int channel = 0; channel < numKeyChannels; ++channel)
+            idlePeak = juce::jmax (idlePeak, DSPKernels::measureLevels (keyChannels[channel], numSamples).peak);
+
+    if (canIdle (chain, idlePeak))
+    {
+        // Resume from exact zero rather than leftover residue
+        for (auto* laneGroups : { &chain.channelLanes, &chain.bandLanes })
+            for (auto& lanes : *laneGroups)
+                lanes.reset();
+
+        for (auto& crossover : chain.crossovers)
+            crossover.reset();
+
+        chain.linkedEnvelope = {};
+
+        // Silence needs no gain: nothing to record, and nothing to apply
+        if (recordingCurve != nullptr)
+        {
+            recordingCurve->extend (numSamples);
+            return meter;
+        }
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            juce::FloatVectorOperations::clear (channels[channel], numSamples);
+
+        gainCurvePosition += numSamples;
+        return meter;
+    }
+
+    // Callers may send more samples than announced in prepare(), so work
+    // through the buffer in chunks that fit the scratch buffers
+    blockGainReductionDb = 0.0f;
+
+    for (int startSample = 0; startSample < numSamples; startSample += maxChunk)
+        processSubBlock (channels, keyChannels, numKeyChannels, numChannels, startSample, juce::jmin (maxChunk, numSamples - startSample));
+
+    if (recordingCurve != nullptr)
+    {
+        recordingCurve->extend (numSamples);
+        return meter;
+    }
+
+    gainCurvePosition += numSamples;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        meter.outputPeak = juce::jmax (meter.outputPeak, DSPKernels::measureLevels (channels[channel], numSamples).peak);
+
+    meter.gainReductionDb = blockGainReductionDb;
+    return meter;
+}
+
+template <typename SampleType>
+bool SmoosherEngine::canIdle (const ChainState<SampleType>& chain, float peak) const
+{
+    // A ramp in progress changes the output even on silence (and has to finish)
+    if (smoothing.isSmoothing())
+        return false;
+
+    if (peak > silenceThreshold)
+        return false;
+
+    for (const auto& crossover : chain.crossovers)
+        if (! crossover.isSilent (silenceThreshold))
+            return false;
+
+    // The detector only runs while compressing. Otherwise its state is
+    // whatever was left when compression stopped, which the idle branch
+    // clears anyway.
+    if (! smoothing.getSettings().compressionActive)
+        return true;
+
+    for (const auto* laneGroups : { &chain.channelLanes, &chain.bandLanes })
+        for (const auto& lanes : *laneGroups)
+            if (! lanes.isSilent (silenceThreshold))
+                return false;
+
+    for (auto envelope : chain.linkedEnvelope)
+        if (envelope > silenceThreshold)
+            return false;
+
+    return true;
+}
+
+template <typename SampleType>
+void SmoosherEngine::processSubBlock (SampleType* const* channels, const SampleType* const* keyChannels, int numKeyChannels,
+                                      int numChannels, int startSample, int numSamples)
+{
+    auto& state = getChainState<SampleType>();
+
+    // Every band of a channel keys off the same sidechain channel
+    if (state.keySource != KeySource::internal)
+        for (int channel = 0; channel < numChannels * state.numBands; ++channel)
+            state.keyChannels[(size_t) channel] = keyChannels[(channel % numChannels) % numKeyChannels] + startSample;
+
+    const auto ramps = smoothing.next (smooshCurve, numSamples);
+
+    // Multiband blocks have nothing to record (the second pass runs their detector)
+    if (recordingCurve != nullptr && state.numBands > 1)
+        return;
+
+    // Only the lane groups of single-band, unlinked processing are independent
+    // enough to run on separate threads
+    const bool parallel = nonRealtime && threadPool != nullptr && state.slices.size() > 1
+                          && state.numBands == 1 && ! state.linked && numSamples >= minParallelBlockSize;
+
+    if (! parallel)
+    {
+        // Pick the specialised chain once per block, so none of the stages has to
+        // look at the mode flags or the channel count while processing. Multiband
+        // always takes the any-channel-count chain.
+        auto chain = getChainFunction<SampleType> (ramps.compressionActive, ramps.saturationActive, ramps.hammerMode,
+                                                   state.numBands > 1 ? 0 : numChannels);
+
+        ChainSlice<SampleType> everything;
+        everything.numChannels = numChannels;
+        everything.laneFrames = state.laneFrames.data();
+        everything.envelopeFrames = state.envelopeFrames.data();
+        everything.controlFrames = state.controlFrames.data();
+
+        (this->*chain) (channels, startSample, numSamples, ramps, everything);
+        blockGainReductionDb = juce::jmax (blockGainReductionDb, everything.gainReductionDb);
+        return;
+    }
+
+    // Every slice but the first goes to the pool, the first runs here
+    auto chain = getChainFunction<SampleType> (ramps.compressionActive, ramps.saturationActive, ramps.hammerMode, 0);
+    int numJobs = 0;
+
+    for (auto& slice : state.slices)
+    {
+        slice.numChannels = juce::jmin (slice.endChannel, numChannels) - slice.firstChannel;
+        slice.gainReductionDb = 0.0f;
+        slice.engine = this;
+        slice.chain = chain;
+        slice.channels = channels;
+        slice.startSample = startSample;
+        slice.numSamples = numSamples;
+        slice.ramps = &ramps;
+
+        if (&slice != &state.slices.front() && slice.numChannels > 0)
+        {
+            auto& job = *sliceJobs[(size_t) numJobs++];
+            job.run = &SmoosherEngine::runSlice<SampleType>;
+            job.slice = &slice;
+            threadPool->addJob (&job, false);
+        }
+    }
+
+    if (state.slices.front().numChannels > 0)
+        runSlice<SampleType> (&state.slices.front());
+
+    for (int i = 0; i < numJobs; ++i)
+        threadPool->waitForJobToFinish (sliceJobs[(size_t) i].get(), -1);
+
+    for (const auto& slice : state.slices)
+        blockGainReductionDb = juce::jmax (blockGainReductionDb, slice.gainReductionDb);
+}
+
+template <typename SampleType>
+void SmoosherEngine::runSlice (void* slicePointer)
+{
+    auto& slice = *static_cast<ChainSlice<SampleType>*> (slicePointer);
+    (slice.engine->*slice.chain) (slice.channels, slice.startSample, slice.numSamples, *slice.ramps, slice);
+}
+
+int SmoosherEngine::getControlRate (const BlockRamps& ramps, int numSamples) const noexcept
+{
+    if (! parameters.controlRate)
+        return 1;
+
+    // The gain can't change much faster than the attack lets the envelope
+    // rise, so take the longest period (up to maxControlRate) that still fits
+    // controlPeriodsPerAttack times into its time constant, in samples
+    const auto attackCoeff = juce::jmin (ramps.settings.attackCoeff,
+                                         ramps.settings.attackCoeff + ramps.increment.attackCoeff * (float) numSamples);
+    const auto timeConstant = -1.0f / std::log (attackCoeff);
+
+    int rate = minControlRate;
+
+    while (rate < maxControlRate && (float) (rate * 2 * controlPeriodsPerAttack) <= timeConstant)
+        rate *= 2;
+
+    return rate;
+}
+
+template <typename SampleType>
+void SmoosherEngine::applyControlGainComputer (SampleType* gainPoints, const SampleType* envelopePoints, int numSamples, int frameSize,
+                                               int controlRate, const SmooshSettings& settings, const SmooshSettings& increment) noexcept
+{
+    // The start point, the evenly spaced points at the end of each whole
+    // period, and the end of a last, shorter period: one kernel call per run,
+    // with the ramps stepping `step` samples per point
+    auto run = [&] (int firstPoint, int numPoints, int firstSample, int step)
+    {
+        auto rampFrom = [firstSample, step] (float start, float perSample)
+        {
+            return DSPKernels::Ramp { start + perSample * (float) firstSample, perSample * (float) step };
+        };
+
+        DSPKernels::applyGainComputer (gainPoints + firstPoint * frameSize, envelopePoints + firstPoint * frameSize, numPoints, frameSize,
+                                       rampFrom (settings.thresholdLog2, increment.thresholdLog2),
+                                       rampFrom (settings.compressionSlope, increment.compressionSlope));
+    };
+
+    const int numWholePeriods = numSamples / controlRate;
+
+    run (0, 1, 0, 0);
+    run (1, numWholePeriods, controlRate - 1, controlRate);
+
+    if (numSamples % controlRate != 0)
+        run (numWholePeriods + 1, 1, numSamples - 1, 0);
+}
+
+//==============================================================================
+template <typename SampleType, bool compress, bool saturate, bool hammer, int fixedChannels>
+void SmoosherEngine::processChain (SampleType* const* channels, int startSample, int numSamples,
+                                   const BlockRamps& ramps, ChainSlice<SampleType>& slice)
+{
+    // Mono and stereo get their channel count baked in, so every per-channel
+    // loop below is unrolled and the lane group loop runs exactly once
+    static_assert (fixedChannels <= ChannelLanes<SampleType>::laneWidth, "fixed layouts must fit one register");
+
+    int numChannels = slice.numChannels;
+
+    if constexpr (fixedChannels > 0)
+    {
+        jassert (numChannels == fixedChannels);
+        numChannels = fixedChannels;
+    }
+
+    const auto& settings = ramps.settings;
+    const auto& increment = ramps.increment;
+
+    // The caller's buffer keeps the dry signal for mixing, the wet chain runs in
+    // the scratch buffers. Everything below only sees the slice's channels.
+    auto& chain = getChainState<SampleType>();
+    jassert (slice.firstChannel == 0 || (chain.numBands == 1 && ! chain.linked));
+
+    channels += slice.firstChannel;
+    auto* const* wetChannels = chain.wetBuffer.getArrayOfWritePointers() + slice.firstChannel;
+    const auto* keyChannels = chain.keyChannels.data() + slice.firstChannel;
+
+    // Two-pass rendering, which only covers single-band processing
+    const bool recording = recordingCurve != nullptr;
+    const bool applyingCurve = gainCurve != nullptr && ! recording && chain.numBands == 1;
+
+    const int controlRate = getControlRate (ramps, numSamples);
+
+    // Stage 1: input gain
+    for (int channel = 0; channel < numChannels; ++channel)
+        DSPKernels::applyGain (wetChannels[channel], channels[channel] + startSample, numSamples, ramps.inputGain);
+
+    // In multiband mode every band of every channel goes through stages 2-4 as
+    // a channel of its own. The split happens even while not compressing, so
+    // the crossover's phase shift doesn't come and go with the smoosh amount.
+    int numBandChannels = numChannels;
+
+    if constexpr (fixedChannels == 0)
+    {
+        if (chain.numBands > 1)
+        {
+            splitBands (chain, numChannels, numSamples);
+            numBandChannels = numChannels * chain.numBands;
+        }
+    }
+
+    if constexpr (compress)
+    {
+        // Stage 2: tube-style saturation (soft clipping with harmonic coloration)
+        if constexpr (saturate)
+            for (int channel = 0; channel < numBandChannels; ++channel)
+                DSPKernels::saturate (wetChannels[channel], numSamples, { settings.saturationAmount, increment.saturationAmount });
+
+        // Stages 3-4: low-pass, sibilance detection, envelope follower and gain
+        // computer, on groups of channels side by side, one channel per SIMD lane.
+        // In the second pass of two-pass rendering only the low-pass runs, and
+        // the recorded gain takes the place of the rest.
+        if (applyingCurve)
+        {
+            for (int group = slice.firstGroup, firstChannel = 0; firstChannel < numChannels; ++group)
+            {
+                auto& lanes = chain.channelLanes[(size_t) group];
+                const int width = lanes.getWidth();
+                const int groupChannels = juce::jmin (width, numChannels - firstChannel);
+
+                ChannelLanes<SampleType>::template interleave<fixedChannels> (wetChannels + firstChannel, groupChannels, slice.laneFrames, width, numSamples);
+                lanes.processLowPass (slice.laneFrames, numSamples, settings, increment);
+                ChannelLanes<SampleType>::template deinterleave<fixedChannels> (slice.laneFrames, wetChannels + firstChannel, groupChannels, width, numSamples);
+
+                firstChannel += width;
+            }
+
+            for (int channel = 0; channel < numChannels; ++channel)
+                gainCurve->apply (slice.firstChannel + channel, gainCurvePosition + startSample, wetChannels[channel], numSamples);
+        }
+        else if (chain.linked)
+        {
+            processLinkedDetector<SampleType, fixedChannels> (chain, numChannels, numSamples, settings, increment,
+                                                              controlRate, slice.gainReductionDb);
+        }
+        else for (int group = slice.firstGroup, firstChannel = 0; firstChannel < numBandChannels; ++group)
+        {
+            auto& lanes = chain.getLanes()[(size_t) group];
+            const int width = lanes.getWidth();
+            const int groupChannels = juce::jmin (width, numBandChannels - firstChannel);
+            auto* laneFrames = slice.laneFrames;
+            auto* envelopeFrames = slice.envelopeFrames;
+
+            ChannelLanes<SampleType>::template interleave<fixedChannels> (wetChannels + firstChannel, groupChannels, laneFrames, width, numSamples);
+
+            if (chain.keySource != KeySource::internal)
+                ChannelLanes<SampleType>::template interleave<fixedChannels> (keyChannels + firstChannel, groupChannels, envelopeFrames, width, numSamples);
+
+            // Control rate: keep the envelope the block starts from, the first
+            // of the points the gain computer runs on
+            if (controlRate > 1)
+                std::copy_n (lanes.envelope.begin(), lanes.numRegisters, slice.controlFrames);
+
+            lanes.process (laneFrames, envelopeFrames, numSamples, settings, increment, chain.keySource);
+
+            meterGainReduction (reinterpret_cast<const SampleType*> (envelopeFrames), numSamples * width, slice.gainReductionDb);
+
+            // Recording: run the gain computer on unity, which leaves the gain
+            if (recording)
+                juce::FloatVectorOperations::fill (reinterpret_cast<SampleType*> (laneFrames), SampleType (1), numSamples * width);
+
+            if (controlRate > 1)
+            {
+                // The envelope at the end of every period too, then the gain at
+                // each point, interpolated in between
+                const int registers = lanes.numRegisters;
+                const int numPoints = (numSamples + controlRate - 1) / controlRate + 1;
+                auto* envelopePoints = slice.controlFrames;
+                auto* gainPoints = envelopePoints + numPoints * registers;
+
+                for (int point = 1; point < numPoints; ++point)
+                    std::copy_n (envelopeFrames + (juce::jmin (point * controlRate, numSamples) - 1) * registers, registers,
+                                 envelopePoints + point * registers);
+
+                juce::FloatVectorOperations::fill (reinterpret_cast<SampleType*> (gainPoints), SampleType (1), numPoints * width);
+
+                applyControlGainComputer (reinterpret_cast<SampleType*> (gainPoints), reinterpret_cast<const SampleType*> (envelopePoints),
+                                          numSamples, width, controlRate, settings, increment);
+
+                lanes.applyControlGain (laneFrames, gainPoints, numSamples, controlRate);
+            }
+            else
+            {
+                DSPKernels::applyGainComputer (reinterpret_cast<SampleType*> (laneFrames),
+                                               reinterpret_cast<const SampleType*> (envelopeFrames),
+                                               numSamples, width,
+                                               { settings.thresholdLog2, increment.thresholdLog2 },
+                                               { settings.compressionSlope, increment.compressionSlope });
+            }
+
+            ChannelLanes<SampleType>::template deinterleave<fixedChannels> (laneFrames, wetChannels + firstChannel, groupChannels, width, numSamples);
+
+            firstChannel += width;
+        }
+    }
+
+    // First pass of two-pass rendering: keep the gain (unity without
+    // compression) and leave the caller's channels alone
+    if (recording)
+    {
+        if constexpr (compress)
+            for (int channel = 0; channel < numChannels; ++channel)
+                recordingCurve->record (slice.firstChannel + channel, recordingCurve->getLength() + startSample,
+                                        chain.linked ? chain.linkedGainFrames.data() : wetChannels[channel], numSamples);
+
+        return;
+    }
+
+    // The bands sum back to the (allpassed) full range signal
+    if constexpr (fixedChannels == 0)
+        for (int band = 1; band < chain.numBands; ++band)
+            for (int channel = 0; channel < numChannels; ++channel)
+                juce::FloatVectorOperations::add (wetChannels[channel], wetChannels[band * numChannels + channel], numSamples);
+
+    // Makeup gain only applies while compressing
+    constexpr DSPKernels::Ramp unity { 1.0f, 0.0f };
+    const auto makeupGain = compress ? DSPKernels::Ramp { settings.makeupGain, increment.makeupGain } : unity;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto* out = channels[channel] + startSample;
+
+        if constexpr (hammer)
+        {
+            // Stage 5: soft limiting to prevent harsh clipping in hammer mode
+            // (applied after makeup gain, which is folded in here first)
+            DSPKernels::applyGain (wetChannels[channel], wetChannels[channel], numSamples, makeupGain);
+            DSPKernels::softLimit (wetChannels[channel], numSamples);
+            DSPKernels::mixDryWet (out, out, wetChannels[channel], numSamples, unity, ramps.outputGain, ramps.mix);
+        }
+        else
+        {
+            // Stage 6: makeup and output gain, dry/wet mix
+            DSPKernels::mixDryWet (out, out, wetChannels[channel], numSamples, makeupGain, ramps.outputGain, ramps.mix);
+        }
+    }
+}
+
+template <typename SampleType, int fixedChannels>
+void SmoosherEngine::processLinkedDetector (ChainState<SampleType>& chain, int numChannels, int numSamples,
+                                            const SmooshSettings& settings, const SmooshSettings& increment,
+                                            int controlRate, float& gainReductionDb)
+{
+    // Low-pass and sibilance detection per channel as usual, then keep the
+    // loudest channel's detector level for every sample, separately per band
+    // (the level and gain of band b start at sample b * numSamples)
+    auto* const* wetChannels = chain.wetBuffer.getArrayOfWritePointers();
+    auto* laneFrames = chain.laneFrames.data();
+    auto* levelFrames = chain.envelopeFrames.data();
+    auto* level = chain.linkedEnvelopeFrames.data();
+    const int numBands = fixedChannels > 0 ? 1 : chain.numBands;
+    const int numBandChannels = numChannels * numBands;
+
+    juce::FloatVectorOperations::clear (level, numSamples * numBands);
+
+    for (int group = 0, firstChannel = 0; firstChannel < numBandChannels; ++group)
+    {
+        auto& lanes = chain.getLanes()[(size_t) group];
+        const int width = lanes.getWidth();
+        const int groupChannels = juce::jmin (width, numBandChannels - firstChannel);
+
+        ChannelLanes<SampleType>::template interleave<fixedChannels> (wetChannels + firstChannel, groupChannels, laneFrames, width, numSamples);
+
+        if (chain.keySource != KeySource::internal)
+            ChannelLanes<SampleType>::template interleave<fixedChannels> (chain.keyChannels.data() + firstChannel, groupChannels, levelFrames, width, numSamples);
+
+        lanes.processDetector (laneFrames, levelFrames, numSamples, settings, increment, chain.keySource);
+
+        const auto* groupLevels = reinterpret_cast<const SampleType*> (levelFrames);
+
+        for (int channel = 0; channel < groupChannels; ++channel)
+        {
+            auto* bandLevel = level + (firstChannel + channel) / numChannels * numSamples;
+
+            for (int sample = 0; sample < numSamples; ++sample)
+                bandLevel[sample] = juce::jmax (bandLevel[sample], groupLevels[sample * width + channel]);
+        }
+
+        ChannelLanes<SampleType>::template deinterleave<fixedChannels> (laneFrames, wetChannels + firstChannel, groupChannels, width, numSamples);
+
+        firstChannel += width;
+    }
+
+    const DSPKernels::Ramp attack { settings.attackCoeff, increment.attackCoeff };
+    const DSPKernels::Ramp release { settings.releaseCoeff, increment.releaseCoeff };
+
+    for (int band = 0; band < numBands; ++band)
+    {
+        auto* bandLevel = level + band * numSamples;
+
+        // One envelope follower, in place over the linked level
+        SampleType envelope = chain.linkedEnvelope[(size_t) band];
+        const auto startEnvelope = envelope;
+
+        for (int sample = 0; sample < numSamples; ++sample)
+        {
+            const float coeff = bandLevel[sample] > envelope ? attack.at (sample) : release.at (sample);
+            envelope = coeff * envelope + (1.0f - coeff) * bandLevel[sample];
+            bandLevel[sample] = envelope;
+        }
+
+        chain.linkedEnvelope[(size_t) band] = envelope;
+
+        meterGainReduction (bandLevel, numSamples, gainReductionDb);
+
+        // One gain computer, whose gain every channel of the band shares
+        auto* gain = chain.linkedGainFrames.data() + band * numSamples;
+
+        if (controlRate > 1)
+        {
+            // Control rate: the gain at the start of the block and the end of
+            // every period, interpolated back to every sample
+            const int numPoints = (numSamples + controlRate - 1) / controlRate + 1;
+            auto* envelopePoints = reinterpret_cast<SampleType*> (chain.controlFrames.data());
+            auto* gainPoints = envelopePoints + numPoints;
+
+            envelopePoints[0] = startEnvelope;
+
+            for (int point = 1; point < numPoints; ++point)
+                envelopePoints[point] = bandLevel[juce::jmin (point * controlRate, numSamples) - 1];
+
+            juce::FloatVectorOperations::fill (gainPoints, SampleType (1), numPoints);
+
+            applyControlGainComputer (gainPoints, envelopePoints, numSamples, 1, controlRate, settings, increment);
+
+            for (int periodStart = 0, point = 0; periodStart < numSamples; periodStart += controlRate, ++point)
+            {
+                const int length = juce::jmin (controlRate, numSamples - periodStart);
+                const auto slope = (gainPoints[point + 1] - gainPoints[point]) / static_cast<SampleType> (length);
+                auto pointGain = gainPoints[point];
+
+                for (int sample = periodStart; sample < periodStart + length; ++sample)
+                {
+                    pointGain += slope;
+                    gain[sample] = pointGain;
+                }
+            }
+        }
+        else
+        {
+            juce::FloatVectorOperations::fill (gain, SampleType (1), numSamples);
+
+            DSPKernels::applyGainComputer (gain, bandLevel, numSamples, 1,
+                                           { settings.thresholdLog2, increment.thresholdLog2 },
+                                           { settings.compressionSlope, increment.compressionSlope });
+        }
+
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            juce::FloatVectorOperations::multiply (wetChannels[band * numChannels + channel], gain, numSamples);
+    }
+}
+
+template <typename SampleType>
+void SmoosherEngine::splitBands (ChainState<SampleType>& chain, int numChannels, int numSamples)
+{
+    // Each crossover takes one register of channels; band b of the group's
+    // channels goes to the same channels numChannels * b further on
+    using Lanes = ChannelLanes<SampleType>;
+    auto* const* wetChannels = chain.wetBuffer.getArrayOfWritePointers();
+    auto* frames = chain.laneFrames.data();
+    auto* bandFrames = chain.bandFrames.data();
+
+    for (int group = 0, firstChannel = 0; firstChannel < numChannels; ++group, firstChannel += Lanes::laneWidth)
+    {
+        const int groupChannels = juce::jmin (Lanes::laneWidth, numChannels - firstChannel);
+
+        Lanes::interleave (wetChannels + firstChannel, groupChannels, frames, Lanes::laneWidth, numSamples);
+
+        chain.crossovers[(size_t) group].process (frames, bandFrames, numSamples, chain.numBands,
+                                                  chain.lowCrossover, chain.highCrossover);
+
+        for (int band = 0; band < chain.numBands; ++band)
+            Lanes::deinterleave (bandFrames + band * numSamples, wetChannels + band * numChannels + firstChannel,
+                                 groupChannels, Lanes::laneWidth, numSamples);
+    }
+}
+
+template <typename SampleType>
+void SmoosherEngine::meterGainReduction (const SampleType* envelope, int count, float& gainReductionDb) const
+{
+    // Reduction at the loudest envelope value, against the threshold and slope
+    // the block ramps to
+    const auto maxEnvelope = static_cast<float> (juce::FloatVectorOperations::findMaximum (envelope, count));
+    const auto& settings = smoothing.getSettings();
+    const auto maxGain = FastMath::computeGain (maxEnvelope, settings.thresholdLog2, settings.compressionSlope);
+    gainReductionDb = juce::jmax (gainReductionDb, -juce::Decibels::gainToDecibels (maxGain));
+}
+
+template <typename SampleType>
+SmoosherEngine::ChainFunction<SampleType> SmoosherEngine::getChainFunction (bool compress, bool saturate, bool hammer, int numChannels)
+{
+    // Saturation and the limiter only exist inside the compressor path
+    auto forChannels = [numChannels] (auto mono, auto stereo, auto any) -> ChainFunction<SampleType>
+    {
+        return numChannels == 1 ? mono : (numChannels == 2 ? stereo : any);
+    };
+
+    #define SMOOSHER_CHAIN(c, s, h) forChannels (&SmoosherEngine::processChain<SampleType, c, s, h, 1>, \
+                                                 &SmoosherEngine::processChain<SampleType, c, s, h, 2>, \
+                                                 &SmoosherEngine::processChain<SampleType, c, s, h, 0>)
+
+    if (! compress)
+        return SMOOSHER_CHAIN (false, false, false);
+
+    if (saturate)
+        return hammer ? SMOOSHER_CHAIN (true, true, true) : SMOOSHER_CHAIN (true, true, false);
+
+    return hammer ? SMOOSHER_CHAIN (true, false, true) : SMOOSHER_CHAIN (true, false, false);
+
+    #undef SMOOSHER_CHAIN
+}
@@ -0,0 +1,321 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_dsp/juce_dsp.h>
+#include "SmooshCurve.h"
+#include "DSPKernels.h"
+#include "ChannelLanes.h"
+#include "Crossover.h"
+#include "MeterFeed.h"
+#include "ParameterRamps.h"
+#include "GainCurve.h"
+
+//==============================================================================
+// The whole Smoosher chain (input gain, saturation, detector, compressor,
+// limiter, output gain and mix) without juce::AudioProcessor, parameter trees
+// or the editor, working on raw channel pointers. SmoosherAudioProcessor is a
+// thin wrapper around it, and the SmoosherDSP library target builds it on its
+// own for headless hosts and tests.
+//
+// prepare() allocates everything; setParameters() and process() never
+// allocate, lock or block, so both can be called from a real-time thread. All
+// three must be called from the same thread (or be externally serialised).
+//
+// For offline rendering, prepare() can also be given a number of threads,
+// which makes the lane groups narrower so there are enough to go round.
+// Offline renders (setNonRealtime (true)) split each block across the lane
+// groups on a thread pool. Real-time playback (setNonRealtime (false)) always
+// processes on the calling thread, as do blocks in linked or multiband mode,
+// whose channels share a detector or crossover state. Either way each channel
+// goes through exactly the same arithmetic, so the output is bit-identical to
+// processing on one thread.
+class SmoosherEngine
+{
+public:
+    // Plain parameter values, in the same units and ranges as the plugin's
+    // parameters
+    struct Parameters
+    {
+        float smoosh = 0.0f;            // 0 - 100 %
+        float inputGainDb = 0.0f;       // 0 - +30 dB
+        float outputGainDb = 0.0f;      // -12 - +12 dB
+        float mix = 100.0f;             // 0 - 100 %, wet
+        bool link = false;
+        KeySource keySource = KeySource::internal;
+        int numBands = 1;               // 1 (multiband off), 2 or 3
+        float lowCrossoverHz = 150.0f;
+        float highCrossoverHz = 2500.0f;
+        bool controlRate = false;       // gain computer once per 4 - 32 samples, interpolated
+    };
+
+    SmoosherEngine();
+    ~SmoosherEngine();
+
+    // Allocates the state and scratch buffers for up to numChannels channels,
+    // in the given precision only, and starts every parameter ramp at the
+    // last values passed to setParameters(). With numThreads > 1, blocks are
+    // split across up to that many threads (the calling one included), which
+    // isn't real-time safe: only use it for offline rendering.
+    void prepare (double sampleRate, int maxBlockSize, int numChannels, bool useDoublePrecision = false, int numThreads = 1);
+
+    // Frees the state and scratch buffers until the next prepare()
+    void release();
+
+    // New targets for the next process() call. Gains, smoosh and mix ramp to
+    // them; the switches take effect at the start of the next block.
+    void setParameters (const Parameters& newParameters) noexcept;
+    const Parameters& getParameters() const noexcept { return parameters; }
+
+    // Whether process() may use the threads from prepare() (the default).
+    // Hosts can switch between offline and real-time rendering without
+    // preparing again, so the plugin passes its current mode every block.
+    void setNonRealtime (bool isNonRealtime) noexcept { nonRealtime = isNonRealtime; }
+
+    // Processes numSamples samples of numChannels channels in place, in the
+    // precision passed to prepare(). Any number of samples works (longer
+    // blocks are split internally); channels beyond the prepared count are
+    // left untouched. keyChannels is the detector key for the sidechain key
+    // sources: channel c keys off keyChannels[c % numKeyChannels], and without
+    // any the detector falls back to the internal key. Returns the block's
+    // levels for metering.
+    MeterFrame process (float* const* channels, int numChannels, int numSamples,
+                        const float* const* keyChannels = nullptr, int numKeyChannels = 0) noexcept;
+    MeterFrame process (double* const* channels, int numChannels, int numSamples,
+                        const double* const* keyChannels = nullptr, int numKeyChannels = 0) noexcept;
+
+    // Two-pass offline rendering, for lookahead without latency. First call
+    // analyse() over the whole clip, block by block as process() would be
+    // called, with a curve reset() to the clip's length: it runs only the
+    // input gain, saturation and detector, records the compressor's gain and
+    // leaves the channels untouched. finish() the curve with the lookahead,
+    // prepare() again, setGainCurve() and process() the clip with the same
+    // parameters: the low-pass still runs, but the recorded gain, its attacks
+    // moved earlier by the lookahead, replaces the detector, which also makes
+    // the second pass cheaper. Multiband blocks aren't recorded and run their
+    // own detector in the second pass. The second pass reports no gain
+    // reduction to the meters.
+    void analyse (const float* const* channels, int numChannels, int numSamples, GainCurve& curve,
+                  const float* const* keyChannels = nullptr, int numKeyChannels = 0) noexcept;
+    void analyse (const double* const* channels, int numChannels, int numSamples, GainCurve& curve,
+                  const double* const* keyChannels = nullptr, int numKeyChannels = 0) noexcept;
+
+    // The finished curve that process() applies from now on, from its first
+    // sample (prepare() also goes back to it), or nullptr for the detector
+    void setGainCurve (const GainCurve* curve) noexcept;
+
+    // Time for the envelope to release below threshold after a peak at
+    // maxInputGainDb of input gain, which is the longest the output can
+    // depend on past input
+    double getTailLengthSeconds (float maxInputGainDb) const;
+
+    // Time for two renders of the same audio that start from different state
+    // to converge: the detector envelopes can differ by at most a full-scale
+    // peak at maxInputGainDb of input gain, and that difference releases
+    // below -120 dBFS. The filters settle long before. This is the warm-up a
+    // chunk rendered apart from the audio before it needs.
+    double getSettlingTimeSeconds (float maxInputGainDb) const;
+
+private:
+    template <typename SampleType>
+    struct ChainSlice;
+
+    template <typename SampleType>
+    using ChainFunction = void (SmoosherEngine::*) (SampleType* const*, int, int, const BlockRamps&, ChainSlice<SampleType>&);
+
+    // A run of whole lane groups that processChain works on: normally every
+    // channel, and in parallel mode one thread's share, with scratch frames
+    // and a gain reduction meter of its own
+    template <typename SampleType>
+    struct ChainSlice
+    {
+        // Lane groups and channels covered when all the prepared channels are used
+        int firstGroup = 0;
+        int firstChannel = 0, endChannel = 0;
+
+        typename ChannelLanes<SampleType>::Lanes* laneFrames = nullptr;
+        typename ChannelLanes<SampleType>::Lanes* envelopeFrames = nullptr;
+        typename ChannelLanes<SampleType>::Lanes* controlFrames = nullptr;
+
+        // The current block
+        int numChannels = 0;
+        float gainReductionDb = 0.0f;
+
+        // What a SliceJob needs to run the block on another thread
+        SmoosherEngine* engine = nullptr;
+        ChainFunction<SampleType> chain = nullptr;
+        SampleType* const* channels = nullptr;
+        int startSample = 0, numSamples = 0;
+        const BlockRamps* ramps = nullptr;
+    };
+
+    // Filter and envelope state plus scratch buffers for one sample type. Only
+    // the one for the precision in use is allocated in prepare().
+    template <typename SampleType>
+    struct ChainState
+    {
+        // Channels this state was prepared for
+        int numMainChannels = 0;
+
+        // Low-pass, sibilance high-pass and envelope follower state, packed into
+        // groups of 1, 2 or 4 SIMD registers of channels, sized for the layout
+        std::vector<ChannelLanes<SampleType>> channelLanes;
+
+        // Multiband mode: bands for this block (1 = off), the crossovers (one
+        // per SIMD register of channels), and the same detector state as
+        // channelLanes for every band of every channel, band by band
+        int numBands = 1;
+        std::vector<Crossover<SampleType>> crossovers;
+        std::vector<ChannelLanes<SampleType>> bandLanes;
+        typename Crossover<SampleType>::Coefficients lowCrossover, highCrossover;
+        float lowCrossoverHz = 0.0f, highCrossoverHz = 0.0f;
+
+        // The detector state in use for this block
+        std::vector<ChannelLanes<SampleType>>& getLanes() noexcept { return numBands > 1 ? bandLanes : channelLanes; }
+
+        // Linked detection: on for this block, the shared envelope of each
+        // band, and scratch for their per-sample envelope and gain
+        bool linked = false;
+        std::array<SampleType, Crossover<SampleType>::maxBands> linkedEnvelope {};
+        std::vector<SampleType> linkedEnvelopeFrames;
+        std::vector<SampleType> linkedGainFrames;
+
+        // Wet signal scratch buffer, with room for every band of every channel
+        // (band b of channel c is channel b * numChannels + c)
+        juce::AudioBuffer<SampleType> wetBuffer;
+
+        // Detector key for this block, and the key channel each wet channel
+        // reads from (pointers into the caller's buffers)
+        KeySource keySource = KeySource::internal;
+        std::vector<const SampleType*> keyChannels;
+
+        // Scratch frames for one lane group (signal and envelope) and for the
+        // crossover's bands, SIMD aligned
+        std::vector<typename ChannelLanes<SampleType>::Lanes> laneFrames;
+        std::vector<typename ChannelLanes<SampleType>::Lanes> envelopeFrames;
+        std::vector<typename ChannelLanes<SampleType>::Lanes> bandFrames;
+
+        // Control-rate gain: the envelope and then the gain at every control
+        // point of one lane group, or of one linked band
+        std::vector<typename ChannelLanes<SampleType>::Lanes> controlFrames;
+
+        // Parallel mode: one slice per thread, and the scratch frames of all
+        // but the first (which uses laneFrames, envelopeFrames and
+        // controlFrames). Empty when processing on one thread.
+        std::vector<ChainSlice<SampleType>> slices;
+        std::vector<typename ChannelLanes<SampleType>::Lanes> sliceFrames;
+
+        void prepare (int numChannels, int maxBlockSize, int numThreads);
+        void release();
+    };
+
+    // Runs one slice of a block on a pool thread
+    class SliceJob;
+
+    template <typename SampleType>
+    static void runSlice (void* slice);
+
+    template <typename SampleType>
+    ChainState<SampleType>& getChainState() noexcept;
+
+    // The whole of process(), for either precision
+    template <typename SampleType>
+    MeterFrame processBlock (SampleType* const* channels, int numChannels, int numSamples,
+                             const SampleType* const* keyChannels, int numKeyChannels) noexcept;
+
+    // True if the block can be skipped: peak of the input and sidechain key
+    // below silenceThreshold, all filter and envelope state in use decayed
+    // below it (the detector's only while compressing), and no parameter ramping
+    template <typename SampleType>
+    bool canIdle (const ChainState<SampleType>& chain, float peak) const;
+
+    // -150 dBFS. Even with every gain in the chain at maximum (about +51 dB)
+    // anything below this stays under the 16-bit noise floor.
+    static constexpr float silenceThreshold = 3.0e-8f;
+
+    // Largest difference in detector state getSettlingTimeSeconds() allows
+    static constexpr float settledLevelDb = -120.0f;
+
+    // Runs the DSP chain over at most wetBuffer.getNumSamples() samples.
+    // keyChannels is only read when the key source uses it.
+    template <typename SampleType>
+    void processSubBlock (SampleType* const* channels, const SampleType* const* keyChannels, int numKeyChannels,
+                          int numChannels, int startSample, int numSamples);
+
+    // Below this many samples, handing a block to the thread pool costs more
+    // than it saves
+    static constexpr int minParallelBlockSize = 256;
+
+    // Control-rate gain: the shortest and longest control periods in samples
+    // (powers of two), and the fewest periods per attack time constant
+    static constexpr int minControlRate = 4;
+    static constexpr int maxControlRate = 32;
+    static constexpr int controlPeriodsPerAttack = 8;
+
+    // Samples per control period for a block, from the fastest attack it
+    // ramps through, or 1 when the gain computer runs every sample
+    int getControlRate (const BlockRamps& ramps, int numSamples) const noexcept;
+
+    // Runs the gain computer on the control points of a block, frameSize
+    // values each: point 0 with the settings at sample 0, and every later one
+    // with those at the sample its envelope comes from, which is
+    // min (point * controlRate, numSamples) - 1
+    template <typename SampleType>
+    static void applyControlGainComputer (SampleType* gainPoints, const SampleType* envelopePoints, int numSamples, int frameSize,
+                                          int controlRate, const SmooshSettings& settings, const SmooshSettings& increment) noexcept;
+
+    // The chain over the channels of one slice, specialised at compile time
+    // for each combination of active stages and for mono/stereo (fixedChannels
+    // = 0 handles any channel count, and multiband mode)
+    template <typename SampleType, bool compress, bool saturate, bool hammer, int fixedChannels>
+    void processChain (SampleType* const* channels, int startSample, int numSamples, const BlockRamps& ramps,
+                       ChainSlice<SampleType>& slice);
+
+    // Multiband mode: splits channels 0 to numChannels - 1 of the wet buffer
+    // into chain.numBands bands in place
+    template <typename SampleType>
+    void splitBands (ChainState<SampleType>& chain, int numChannels, int numSamples);
+
+    // Stages 3-4 in linked mode: per-channel low-pass and sibilance detection,
+    // then one envelope follower and gain computer per band on its loudest
+    // channel (the gain computer once per controlRate samples)
+    template <typename SampleType, int fixedChannels>
+    void processLinkedDetector (ChainState<SampleType>& chain, int numChannels, int numSamples,
+                                const SmooshSettings& settings, const SmooshSettings& increment,
+                                int controlRate, float& gainReductionDb);
+
+    // Folds the largest gain reduction implied by `envelope` into gainReductionDb
+    template <typename SampleType>
+    void meterGainReduction (const SampleType* envelope, int count, float& gainReductionDb) const;
+
+    template <typename SampleType>
+    static ChainFunction<SampleType> getChainFunction (bool compress, bool saturate, bool hammer, int numChannels);
+
+    Parameters parameters;
+
+    // Smoosh -> compressor settings table for the current sample rate, and
+    // the parameter smoothing
+    SmooshCurve smooshCurve;
+    ParameterRamps smoothing;
+
+    ChainState<float> floatChain;
+    ChainState<double> doubleChain;
+
+    // Parallel mode: a job per slice beyond the first, and the threads that run
+    // them (declared last, so the pool stops before its jobs are destroyed)
+    std::vector<std::unique_ptr<SliceJob>> sliceJobs;
+    std::unique_ptr<juce::ThreadPool> threadPool;
+    bool nonRealtime = true;
+
+    // Two-pass rendering: the curve analyse() is recording into (only during
+    // the call), and the curve process() applies with the sample it's up to
+    GainCurve* recordingCurve = nullptr;
+    const GainCurve* gainCurve = nullptr;
+    juce::int64 gainCurvePosition = 0;
+
+    // Largest gain reduction in the current block, for its MeterFrame
+    float blockGainReductionDb = 0.0f;
+
+    double currentSampleRate = 44100.0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SmoosherEngine)
+};
@@ -0,0 +1,97 @@
+#include "ThrottledSliderAttachment.h"
+
+//==============================================================================
+ThrottledSliderAttachment::ThrottledSliderAttachment (juce::AudioProcessorValueTreeState& state,
+                                                      const juce::String& parameterID,
+                                                      juce::Slider& s)
+    : slider (s),
+      attachment (*state.getParameter (parameterID),
+                  [this] (float newValue) { parameterChanged (newValue); },
+                  state.undoManager)
+{
+    auto& parameter = *state.getParameter (parameterID);
+    const auto range = parameter.getNormalisableRange();
+
+    // Every Smoosher parameter is linear, so the slider can take the range as is
+    slider.setNormalisableRange ({ (double) range.start, (double) range.end, (double) range.interval, (double) range.skew });
+    slider.setDoubleClickReturnValue (true, range.convertFrom0to1 (parameter.getDefaultValue()));
+
+    slider.textFromValueFunction = [&parameter] (double value)
+    {
+        return parameter.getText (parameter.convertTo0to1 ((float) value), 0);
+    };
+
+    slider.valueFromTextFunction = [&parameter] (const juce::String& text)
+    {
+        return (double) parameter.convertFrom0to1 (parameter.getValueForText (text));
+    };
+
+    attachment.sendInitialUpdate();
+    slider.addListener (this);
+}
+
+ThrottledSliderAttachment::~ThrottledSliderAttachment()
+{
+    slider.removeListener (this);
+}
+
+//==============================================================================
+void ThrottledSliderAttachment::parameterChanged (float newValue)
+{
+    if (ignoreCallbacks)
+        return;
+
+    // Catch up immediately after a quiet period, otherwise hold the value until
+    // the current interval is over
+    constexpr juce::uint32 intervalMs = 1000 / maxUpdatesPerSecond;
+    const auto elapsed = juce::Time::getMillisecondCounter() - lastUpdateMs;
+
+    if (elapsed >= intervalMs && ! isTimerRunning())
+    {
+        applyToSlider (newValue);
+        return;
+    }
+
+    pendingValue = newValue;
+
+    if (! isTimerRunning())
+        startTimer ((int) (intervalMs - juce::jmin (elapsed, intervalMs)) + 1);
+}
+
+void ThrottledSliderAttachment::applyToSlider (float newValue)
+{
+    lastUpdateMs = juce::Time::getMillisecondCounter();
+
+    const juce::ScopedValueSetter<bool> svs (ignoreCallbacks, true);
+    slider.setValue (newValue, juce::sendNotificationSync);
+}
+
+void ThrottledSliderAttachment::timerCallback()
+{
+    stopTimer();
+    applyToSlider (pendingValue);
+}
+
+//==============================================================================
+void ThrottledSliderAttachment::sliderValueChanged (juce::Slider*)
+{
+    if (ignoreCallbacks)
+        return;
+
+    // The parameter echoes the change straight back, which must not be held
+    // and re-applied later over the user's newer values
+    const juce::ScopedValueSetter<bool> svs (ignoreCallbacks, true);
+    attachment.setValueAsPartOfGesture ((float) slider.getValue());
+}
+
+void ThrottledSliderAttachment::sliderDragStarted (juce::Slider*)
+{
+    // The user takes over, so a held automation value is stale
+    stopTimer();
+    attachment.beginGesture();
+}
+
+void ThrottledSliderAttachment::sliderDragEnded (juce::Slider*)
+{
+    attachment.endGesture();
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+// Connects a Slider to a parameter like AudioProcessorValueTreeState::
+// SliderAttachment, but applies host-side changes (automation, other editors)
+// to the slider at most maxUpdatesPerSecond times. Fast automation otherwise
+// repaints every knob on every parameter change. The last value always lands,
+// at most one interval late, and the user's own edits are never delayed.
+class ThrottledSliderAttachment : private juce::Slider::Listener,
+                                  private juce::Timer
+{
+public:
+    ThrottledSliderAttachment (juce::AudioProcessorValueTreeState& state, const juce::String& parameterID,
+                               juce::Slider& slider);
+    ~ThrottledSliderAttachment() override;
+
+    static constexpr int maxUpdatesPerSecond = 30;
+
+private:
+    void parameterChanged (float newValue);
+    void applyToSlider (float newValue);
+
+    void timerCallback() override;
+
+    void sliderValueChanged (juce::Slider*) override;
+    void sliderDragStarted (juce::Slider*) override;
+    void sliderDragEnded (juce::Slider*) override;
+
+    juce::Slider& slider;
+    juce::ParameterAttachment attachment;
+
+    float pendingValue = 0.0f;
+    juce::uint32 lastUpdateMs = 0;
+    bool ignoreCallbacks = false;
+
+    JUCE_DECLARE_NON_COPYABLE (ThrottledSliderAttachment)
+};
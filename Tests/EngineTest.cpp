@@ -0,0 +1,469 @@
+#include "../Source/SmoosherEngine.h"
+#include "../Source/SmoosherBatch.h"
+
+#include <iostream>
+#include <thread>
+
+//==============================================================================
+// SmoosherEngine test, built against the SmoosherDSP library only (no plugin
+// wrapper, JuceHeader.h or GUI modules), so it also checks that the library
+// stays self-contained.
+//
+// Runs the engine on raw channel pointers and checks that it compresses, that
+// the result doesn't depend on how the audio is split into process() calls,
+// that the double-precision path matches the float one, and that a sidechain
+// key passed as plain pointers drives the detector, also over silent input.
+// Then checks SmoosherBatch against one SmoosherEngine per stream, an engine
+// processing on several threads against one on a single thread, two-pass
+// rendering with lookahead against a single pass, control-rate gain against
+// the audio-rate gain, and that a MeterFeed filled while nobody reads it
+// doesn't hand stale frames to the next reader.
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int numChannels = 2;
+    constexpr int length = 96000;
+    constexpr int maxBlockSize = 512;
+
+    // Small LCG so the input is identical on every platform
+    struct Noise
+    {
+        std::uint32_t state;
+
+        float next() noexcept
+        {
+            state = state * 1664525u + 1013904223u;
+            return static_cast<float> (state >> 8) / 8388608.0f - 1.0f;
+        }
+    };
+
+    // Noise hits over a low sine, loud enough to compress at any Smoosh amount
+    std::vector<std::vector<float>> createInput()
+    {
+        std::vector<std::vector<float>> input (numChannels, std::vector<float> ((size_t) length));
+        Noise noise { 0x5eed0000u };
+
+        for (int i = 0; i < length; ++i)
+        {
+            const auto t = (double) i / sampleRate;
+            const auto hit = std::exp (-std::fmod (t, 0.1) / 0.02);
+
+            for (int channel = 0; channel < numChannels; ++channel)
+                input[(size_t) channel][(size_t) i] = (float) (0.4 * std::sin (juce::MathConstants<double>::twoPi * (110.0 + 55.0 * channel) * t)
+                                                              + 0.5 * hit * noise.next());
+        }
+
+        return input;
+    }
+
+    struct Render
+    {
+        std::vector<std::vector<double>> output;
+        float maxGainReductionDb = 0.0f;
+    };
+
+    // Processes `input` in blocks of blockSizes[0], blockSizes[1], ... (cycling)
+    template <typename SampleType>
+    Render render (const std::vector<std::vector<float>>& input, const SmoosherEngine::Parameters& parameters,
+                   std::initializer_list<int> blockSizes, const std::vector<float>* key = nullptr)
+    {
+        SmoosherEngine engine;
+        engine.setParameters (parameters);
+        engine.prepare (sampleRate, maxBlockSize, numChannels, std::is_same_v<SampleType, double>);
+
+        std::vector<std::vector<SampleType>> buffer;
+        for (const auto& channel : input)
+            buffer.emplace_back (channel.begin(), channel.end());
+
+        std::vector<SampleType> keyBuffer;
+        if (key != nullptr)
+            keyBuffer.assign (key->begin(), key->end());
+
+        Render result;
+        auto nextBlockSize = blockSizes.begin();
+
+        for (int start = 0; start < length;)
+        {
+            const auto numSamples = juce::jmin (*nextBlockSize, length - start);
+
+            if (++nextBlockSize == blockSizes.end())
+                nextBlockSize = blockSizes.begin();
+
+            SampleType* channels[numChannels];
+            for (int channel = 0; channel < numChannels; ++channel)
+                channels[channel] = buffer[(size_t) channel].data() + start;
+
+            const SampleType* keyChannels[] = { keyBuffer.data() + start };
+            const auto meter = engine.process (channels, numChannels, numSamples,
+                                               key != nullptr ? keyChannels : nullptr, key != nullptr ? 1 : 0);
+
+            result.maxGainReductionDb = juce::jmax (result.maxGainReductionDb, meter.gainReductionDb);
+            start += numSamples;
+        }
+
+        for (const auto& channel : buffer)
+            result.output.emplace_back (channel.begin(), channel.end());
+
+        return result;
+    }
+
+    double maxDifference (const Render& a, const Render& b)
+    {
+        double difference = 0.0;
+
+        for (size_t channel = 0; channel < a.output.size(); ++channel)
+            for (size_t i = 0; i < a.output[channel].size(); ++i)
+                difference = juce::jmax (difference, std::abs (a.output[channel][i] - b.output[channel][i]));
+
+        return difference;
+    }
+
+    bool isFinite (const Render& r)
+    {
+        for (const auto& channel : r.output)
+            for (auto x : channel)
+                if (! std::isfinite (x))
+                    return false;
+
+        return true;
+    }
+}
+
+//==============================================================================
+int main()
+{
+    const auto input = createInput();
+    int numFailures = 0;
+
+    auto expect = [&numFailures] (bool passed, const char* label, double value)
+    {
+        std::cout << (passed ? "  ok    " : "  FAIL  ") << label << ": " << value << "\n";
+
+        if (! passed)
+            ++numFailures;
+    };
+
+    for (auto numBands : { 1, 3 })
+    {
+        SmoosherEngine::Parameters parameters;
+        parameters.smoosh = 70.0f;
+        parameters.inputGainDb = 12.0f;
+        parameters.numBands = numBands;
+
+        std::cout << (numBands == 1 ? "Single band\n" : "Three bands\n");
+
+        const auto reference = render<float> (input, parameters, { maxBlockSize });
+        expect (isFinite (reference) && reference.maxGainReductionDb > 3.0f, "gain reduction (dB)", reference.maxGainReductionDb);
+
+        // Constant parameters, so the block size mustn't change a single sample,
+        // including blocks longer than the prepared size
+        const auto split = render<float> (input, parameters, { 1, 17, 333, 64, 2048 });
+        expect (maxDifference (reference, split) == 0.0, "odd block sizes, max difference", maxDifference (reference, split));
+
+        const auto precise = render<double> (input, parameters, { maxBlockSize });
+        expect (maxDifference (reference, precise) < 1.0e-4, "double precision, max difference", maxDifference (reference, precise));
+    }
+
+    std::cout << "Sidechain\n";
+    {
+        SmoosherEngine::Parameters parameters;
+        parameters.smoosh = 70.0f;
+        parameters.inputGainDb = 12.0f;
+        parameters.keySource = KeySource::sidechainDirect;
+
+        // A silent key never triggers the compressor, however loud the input
+        const std::vector<float> silentKey ((size_t) length, 0.0f);
+        const auto keyed = render<float> (input, parameters, { maxBlockSize }, &silentKey);
+        expect (keyed.maxGainReductionDb == 0.0f, "silent key, gain reduction (dB)", keyed.maxGainReductionDb);
+
+        // Without key channels the detector falls back to the signal itself
+        const auto internal = render<float> (input, parameters, { maxBlockSize });
+        expect (internal.maxGainReductionDb > 0.0f, "no key, gain reduction (dB)", internal.maxGainReductionDb);
+
+        // A loud key over silent input keeps the detector running, so a bed
+        // coming in under it halfway through is ducked from its first sample,
+        // just like one coming in over a -140 dBFS floor that never idles
+        auto bedInput = input, flooredInput = input;
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            std::fill_n (bedInput[(size_t) channel].begin(), length / 2, 0.0f);
+            std::fill_n (flooredInput[(size_t) channel].begin(), length / 2, 1.0e-7f);
+        }
+
+        const auto bed = render<float> (bedInput, parameters, { maxBlockSize }, &input[0]);
+        const auto floored = render<float> (flooredInput, parameters, { maxBlockSize }, &input[0]);
+        expect (maxDifference (bed, floored) < 1.0e-4, "bed onset under a loud key, max difference", maxDifference (bed, floored));
+    }
+
+    std::cout << "Batch\n";
+    {
+        // Streams from bypass through hammer mode with different gains and
+        // mix, in two lane groups processed by two worker threads. Halfway
+        // through, the compressing streams move to new settings.
+        constexpr int numStreams = 12;
+        const float smoosh[] = { 0.0f, 20.0f, 35.0f, 50.0f, 65.0f, 80.0f, 100.0f };
+
+        auto streamParameters = [&smoosh] (int stream, bool secondHalf)
+        {
+            SmoosherEngine::Parameters parameters;
+            parameters.smoosh = smoosh[stream % 7];
+            parameters.inputGainDb = (float) (stream % 4) * 4.0f;
+            parameters.outputGainDb = (float) (stream % 3) - 1.0f;
+            parameters.mix = stream % 5 == 4 ? 60.0f : 100.0f;
+
+            if (secondHalf && parameters.smoosh > 0.0f)
+            {
+                parameters.smoosh = 110.0f - parameters.smoosh;
+                parameters.inputGainDb += 2.0f;
+            }
+
+            return parameters;
+        };
+
+        SmoosherBatch batch;
+        batch.prepare (sampleRate, maxBlockSize, numStreams, numChannels, 2);
+
+        std::vector<SmoosherEngine> engines (numStreams);
+        std::vector<std::vector<float>> batchBuffer, engineBuffer;
+
+        for (int stream = 0; stream < numStreams; ++stream)
+        {
+            batch.setParameters (stream, streamParameters (stream, false));
+            batch.resetStream (stream);
+            engines[(size_t) stream].setParameters (streamParameters (stream, false));
+            engines[(size_t) stream].prepare (sampleRate, maxBlockSize, numChannels);
+
+            for (const auto& channel : input)
+            {
+                batchBuffer.push_back (channel);
+                engineBuffer.push_back (channel);
+            }
+        }
+
+        expect (batch.getNumGroups() == 2, "lane groups", batch.getNumGroups());
+
+        for (int start = 0; start < length; start += maxBlockSize)
+        {
+            const auto numSamples = juce::jmin (maxBlockSize, length - start);
+
+            if (start == length / 2)
+            {
+                for (int stream = 0; stream < numStreams; ++stream)
+                {
+                    batch.setParameters (stream, streamParameters (stream, true));
+                    engines[(size_t) stream].setParameters (streamParameters (stream, true));
+                }
+            }
+
+            std::vector<float*> batchChannels, engineChannels;
+            for (size_t channel = 0; channel < batchBuffer.size(); ++channel)
+            {
+                batchChannels.push_back (batchBuffer[channel].data() + start);
+                engineChannels.push_back (engineBuffer[channel].data() + start);
+            }
+
+            std::thread worker ([&] { batch.processGroups (1, 1, 1, batchChannels.data(), numSamples); });
+            batch.processGroups (0, 0, 1, batchChannels.data(), numSamples);
+            worker.join();
+
+            for (int stream = 0; stream < numStreams; ++stream)
+                engines[(size_t) stream].process (engineChannels.data() + stream * numChannels, numChannels, numSamples);
+        }
+
+        double difference = 0.0;
+        for (size_t channel = 0; channel < batchBuffer.size(); ++channel)
+            for (int i = 0; i < length; ++i)
+                difference = juce::jmax (difference, (double) std::abs (batchBuffer[channel][(size_t) i] - engineBuffer[channel][(size_t) i]));
+
+        // Each lane runs the same kernels on the same values as the engine's
+        // channel, so the streams must match it sample for sample
+        expect (difference == 0.0, "vs. one engine per stream, max difference", difference);
+    }
+
+    std::cout << "Parallel\n";
+    {
+        // A 7.1.4 bed with a stereo key, on four threads and on one. The
+        // second and third quarters switch to linked and multiband mode (which
+        // run on one thread) and the last one back to parallel processing.
+        constexpr int numBedChannels = 12;
+        SmoosherEngine serial, parallel;
+
+        SmoosherEngine::Parameters parameters;
+        parameters.smoosh = 80.0f;
+        parameters.inputGainDb = 10.0f;
+        parameters.keySource = KeySource::sidechain;
+
+        for (auto* engine : { &serial, &parallel })
+        {
+            engine->setParameters (parameters);
+            engine->prepare (sampleRate, maxBlockSize, numBedChannels, false, engine == &parallel ? 4 : 1);
+        }
+
+        std::vector<std::vector<float>> serialBuffer, parallelBuffer;
+        for (int channel = 0; channel < numBedChannels; ++channel)
+        {
+            auto signal = input[(size_t) (channel % numChannels)];
+            for (auto& x : signal)
+                x *= 0.3f + 0.1f * (float) channel;
+
+            serialBuffer.push_back (signal);
+            parallelBuffer.push_back (signal);
+        }
+
+        bool sameMeters = true;
+
+        for (int start = 0; start < length; start += maxBlockSize)
+        {
+            const auto numSamples = juce::jmin (maxBlockSize, length - start);
+            const int quarter = start * 4 / length;
+
+            parameters.link = quarter == 1;
+            parameters.numBands = quarter == 2 ? 3 : 1;
+
+            std::vector<float*> serialChannels, parallelChannels;
+            for (int channel = 0; channel < numBedChannels; ++channel)
+            {
+                serialChannels.push_back (serialBuffer[(size_t) channel].data() + start);
+                parallelChannels.push_back (parallelBuffer[(size_t) channel].data() + start);
+            }
+
+            const float* keyChannels[] = { input[0].data() + start, input[1].data() + start };
+
+            serial.setParameters (parameters);
+            parallel.setParameters (parameters);
+            const auto serialMeter = serial.process (serialChannels.data(), numBedChannels, numSamples, keyChannels, 2);
+            const auto parallelMeter = parallel.process (parallelChannels.data(), numBedChannels, numSamples, keyChannels, 2);
+
+            sameMeters = sameMeters && serialMeter.gainReductionDb == parallelMeter.gainReductionDb;
+        }
+
+        double difference = 0.0;
+        for (int channel = 0; channel < numBedChannels; ++channel)
+            for (int i = 0; i < length; ++i)
+                difference = juce::jmax (difference, (double) std::abs (serialBuffer[(size_t) channel][(size_t) i]
+                                                                          - parallelBuffer[(size_t) channel][(size_t) i]));
+
+        expect (difference == 0.0, "vs. one thread, max difference", difference);
+        expect (sameMeters, "same gain reduction meter", sameMeters ? 1.0 : 0.0);
+    }
+
+    std::cout << "Two-pass\n";
+    {
+        SmoosherEngine::Parameters parameters;
+        parameters.smoosh = 60.0f;
+        parameters.inputGainDb = 12.0f;
+
+        auto peakOf = [] (const Render& r)
+        {
+            double peak = 0.0;
+            for (const auto& channel : r.output)
+                for (auto x : channel)
+                    peak = juce::jmax (peak, std::abs (x));
+            return peak;
+        };
+
+        const auto singlePass = render<float> (input, parameters, { maxBlockSize });
+
+        // First pass: record the gain, without touching the input
+        SmoosherEngine engine;
+        engine.setParameters (parameters);
+        engine.prepare (sampleRate, maxBlockSize, numChannels);
+
+        GainCurve curve;
+        curve.reset (numChannels, length);
+
+        auto analysed = input;
+        for (int start = 0; start < length; start += maxBlockSize)
+        {
+            const float* channels[] = { analysed[0].data() + start, analysed[1].data() + start };
+            engine.analyse (channels, numChannels, juce::jmin (maxBlockSize, length - start), curve);
+        }
+
+        expect (analysed == input && curve.getLength() == length, "first pass leaves the input alone", 1.0);
+
+        // Second pass with 2 ms of lookahead: the noise hits start at full
+        // level, and the reduction now arrives before them
+        curve.finish ((int) (0.002 * sampleRate));
+        engine.prepare (sampleRate, maxBlockSize, numChannels);
+        engine.setGainCurve (&curve);
+
+        Render twoPass;
+        auto buffer = input;
+        for (int start = 0; start < length; start += maxBlockSize)
+        {
+            float* channels[] = { buffer[0].data() + start, buffer[1].data() + start };
+            engine.process (channels, numChannels, juce::jmin (maxBlockSize, length - start));
+        }
+
+        for (const auto& channel : buffer)
+            twoPass.output.emplace_back (channel.begin(), channel.end());
+
+        expect (isFinite (twoPass) && peakOf (twoPass) < 0.9 * peakOf (singlePass), "output peak vs. single pass", peakOf (twoPass) / peakOf (singlePass));
+    }
+
+    std::cout << "Control rate\n";
+    for (auto link : { false, true })
+    {
+        // Below hammer mode, so the output is the low-pass times makeup and
+        // the compressor gain, and the ratio of two outputs is the ratio of
+        // their gains
+        SmoosherEngine::Parameters parameters;
+        parameters.smoosh = 50.0f;
+        parameters.inputGainDb = 12.0f;
+        parameters.link = link;
+
+        const auto audioRate = render<float> (input, parameters, { maxBlockSize });
+
+        parameters.controlRate = true;
+        const auto controlRate = render<float> (input, parameters, { maxBlockSize });
+
+        double maxErrorDb = 0.0;
+
+        for (size_t channel = 0; channel < audioRate.output.size(); ++channel)
+            for (size_t i = 0; i < audioRate.output[channel].size(); ++i)
+                if (std::abs (audioRate.output[channel][i]) > 1.0e-3)
+                    maxErrorDb = juce::jmax (maxErrorDb, std::abs (20.0 * std::log10 (controlRate.output[channel][i] / audioRate.output[channel][i])));
+
+        expect (isFinite (controlRate) && controlRate.maxGainReductionDb > 3.0f,
+                link ? "linked, gain reduction (dB)" : "gain reduction (dB)", controlRate.maxGainReductionDb);
+        expect (maxErrorDb <= 0.5, link ? "linked, max gain error vs. audio rate (dB)" : "max gain error vs. audio rate (dB)", maxErrorDb);
+    }
+
+    std::cout << "Meter feed\n";
+    {
+        // With no editor reading, the audio thread fills the feed and then has
+        // its frames dropped. A new consumer discards that backlog first, so
+        // the first thing it shows is the next live frame.
+        MeterFeed feed;
+        MeterFrame stale;
+        stale.inputPeak = 1.0f;
+        stale.gainReductionDb = 12.0f;
+
+        int numQueued = 0;
+
+        for (int i = 0; i < 2 * MeterFeed::capacity; ++i)
+            numQueued += feed.push (stale) ? 1 : 0;
+
+        expect (numQueued == MeterFeed::capacity - 1, "frames queued with no consumer", numQueued);
+        expect (feed.discardAll() == numQueued, "frames discarded by a new consumer", numQueued);
+
+        MeterFrame live;
+        live.inputPeak = 0.25f;
+        live.gainReductionDb = 3.0f;
+        feed.push (live);
+
+        MeterFrame seen;
+        const auto numSeen = feed.popAll ([&seen] (const MeterFrame& frame)
+        {
+            seen.inputPeak = juce::jmax (seen.inputPeak, frame.inputPeak);
+            seen.gainReductionDb = juce::jmax (seen.gainReductionDb, frame.gainReductionDb);
+        });
+
+        expect (numSeen == 1 && seen.inputPeak == live.inputPeak && seen.gainReductionDb == live.gainReductionDb,
+                "frames seen after the backlog", numSeen);
+    }
+
+    std::cout << (numFailures == 0 ? "\nAll checks passed\n" : "\nSome checks failed\n");
+    return numFailures == 0 ? 0 : 1;
+}
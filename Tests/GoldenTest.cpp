@@ -0,0 +1,405 @@
+#include <JuceHeader.h>
+#include "../Source/PluginProcessor.h"
+#include "../Source/FactoryPresets.h"
+
+//==============================================================================
+// Golden-output regression test.
+//
+// Renders a deterministic test signal through every factory preset and through
+// parameter sweeps, and compares each render against a stored reference in
+// Tests/Golden. For every render it reports the max abs error, the RMS error
+// and the null depth (RMS error relative to the reference, in dB), and fails
+// if any of them is outside tolerance. Presets are also rendered with an odd
+// block size, with every kernel instruction set the CPU supports and through
+// the double-precision processBlock, all against the same reference.
+//
+//   smoosher_golden_test [--update] [--max-abs <x>] [--max-rms <x>]
+//                        [--min-null <dB>] [--ref-dir <dir>] [--out-dir <dir>]
+//
+// --update rewrites the references from the current build. Only do that after
+// checking by ear that a change in sound is intended. A missing reference is a
+// failure, so a checkout without them can't pass by testing nothing.
+namespace
+{
+    constexpr double sampleRate = 44100.0;
+    constexpr int numChannels = 2;
+    constexpr int referenceBlockSize = 512;
+
+    struct Tolerances
+    {
+        float maxAbs = 1.0e-4f;     // -80 dBFS
+        float maxRms = 1.0e-5f;     // -100 dBFS
+        float minNullDb = 80.0f;    // error at least 80 dB below the reference
+    };
+
+    struct Settings
+    {
+        float smoosh, inputGain, outputGain, mix;
+    };
+
+    //==============================================================================
+    // Small LCG so the noise is identical on every platform and JUCE version
+    struct Noise
+    {
+        std::uint32_t state;
+
+        float next() noexcept
+        {
+            state = state * 1664525u + 1013904223u;
+            return static_cast<float> (state >> 8) / 8388608.0f - 1.0f;
+        }
+    };
+
+    // Two seconds of programme-like material per channel: a log sine sweep,
+    // decaying noise hits (transients for the envelope follower), high-passed
+    // noise bursts (sibilance detector) and a quiet passage with a gap of
+    // silence, at levels that span the Smoosh thresholds.
+    juce::AudioBuffer<float> createTestSignal()
+    {
+        const auto length = juce::roundToInt (sampleRate * 2.0);
+        juce::AudioBuffer<float> signal (numChannels, length);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            Noise noise { 0x5eed0000u + (std::uint32_t) channel };
+            auto* data = signal.getWritePointer (channel);
+            double phase = 0.0;
+            float highPassState = 0.0f;
+
+            for (int i = 0; i < length; ++i)
+            {
+                const auto t = (double) i / sampleRate;
+                float x = 0.0f;
+
+                if (t < 0.6)
+                {
+                    // 40 Hz -> 16 kHz, the right channel a little quieter
+                    const auto frequency = 40.0 * std::pow (400.0, t / 0.6);
+                    phase += juce::MathConstants<double>::twoPi * frequency / sampleRate;
+                    x = (float) std::sin (phase) * (channel == 0 ? 0.5f : 0.35f);
+                }
+                else if (t < 1.2)
+                {
+                    // Hits every 75 ms, 5 ms attack, 30 ms decay
+                    const auto local = std::fmod (t - 0.6, 0.075);
+                    const auto envelope = local < 0.005 ? local / 0.005 : std::exp (-(local - 0.005) / 0.03);
+                    x = noise.next() * (float) envelope * 0.9f;
+                }
+                else if (t < 1.6)
+                {
+                    // Sibilant bursts: first difference of noise, gated
+                    const auto n = noise.next();
+                    const auto bright = n - highPassState;
+                    highPassState = n;
+                    x = std::fmod (t, 0.1) < 0.06 ? bright * 0.3f : 0.0f;
+                }
+                else if (t < 1.8)
+                {
+                    phase += juce::MathConstants<double>::twoPi * 220.0 / sampleRate;
+                    x = (float) std::sin (phase) * 0.05f + noise.next() * 0.01f;
+                }
+
+                data[i] = x;
+            }
+        }
+
+        return signal;
+    }
+
+    //==============================================================================
+    void setParameter (SmoosherAudioProcessor& processor, const char* id, float value)
+    {
+        auto* parameter = processor.getAPVTS().getParameter (id);
+        parameter->setValueNotifyingHost (parameter->convertTo0to1 (value));
+    }
+
+    void applySettings (SmoosherAudioProcessor& processor, const Settings& settings)
+    {
+        setParameter (processor, "smoosh", settings.smoosh);
+        setParameter (processor, "inputGain", settings.inputGain);
+        setParameter (processor, "outputGain", settings.outputGain);
+        setParameter (processor, "mix", settings.mix);
+    }
+
+    // Renders `input` in blocks of blockSize. `automation` (if any) is called
+    // before each block with the block's position in 0..1, like host automation.
+    // With SampleType = double the processor runs in double precision, and the
+    // result is rounded back to float for comparing.
+    template <typename SampleType = float>
+    juce::AudioBuffer<float> render (const juce::AudioBuffer<float>& input, const Settings& initial, int blockSize,
+                                     std::function<Settings (float)> automation = {})
+    {
+        SmoosherAudioProcessor processor;
+        applySettings (processor, initial);
+
+        const auto stereo = juce::AudioChannelSet::stereo();
+        processor.setBusesLayout ({ { stereo, juce::AudioChannelSet::disabled() }, { stereo } });
+        processor.setProcessingPrecision (std::is_same_v<SampleType, double> ? juce::AudioProcessor::doublePrecision
+                                                                               : juce::AudioProcessor::singlePrecision);
+        processor.setRateAndBufferSizeDetails (sampleRate, blockSize);
+        processor.prepareToPlay (sampleRate, blockSize);
+
+        juce::AudioBuffer<SampleType> output;
+        output.makeCopyOf (input);
+        juce::MidiBuffer midi;
+
+        for (int start = 0; start < output.getNumSamples(); start += blockSize)
+        {
+            const auto numSamples = juce::jmin (blockSize, output.getNumSamples() - start);
+
+            if (automation)
+                applySettings (processor, automation ((float) start / (float) output.getNumSamples()));
+
+            juce::AudioBuffer<SampleType> block (output.getArrayOfWritePointers(), numChannels, start, numSamples);
+            processor.processBlock (block, midi);
+        }
+
+        processor.releaseResources();
+
+        juce::AudioBuffer<float> result;
+        result.makeCopyOf (output);
+        return result;
+    }
+
+    //==============================================================================
+    struct Comparison
+    {
+        float maxAbs = 0.0f;
+        float rms = 0.0f;
+        float nullDb = 0.0f;    // reference RMS over error RMS, in dB
+
+        bool passes (const Tolerances& tolerances) const
+        {
+            return maxAbs <= tolerances.maxAbs && rms <= tolerances.maxRms && nullDb >= tolerances.minNullDb;
+        }
+    };
+
+    Comparison compare (const juce::AudioBuffer<float>& actual, const juce::AudioBuffer<float>& reference)
+    {
+        double errorSquares = 0.0, referenceSquares = 0.0;
+        Comparison result;
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            for (int i = 0; i < actual.getNumSamples(); ++i)
+            {
+                const auto r = reference.getSample (channel, i);
+                const auto error = actual.getSample (channel, i) - r;
+
+                result.maxAbs = juce::jmax (result.maxAbs, std::abs (error));
+                errorSquares += (double) error * error;
+                referenceSquares += (double) r * r;
+            }
+        }
+
+        const auto count = (double) numChannels * actual.getNumSamples();
+        result.rms = (float) std::sqrt (errorSquares / count);
+
+        // An exact match reports 200 dB rather than infinity
+        result.nullDb = errorSquares > 0.0 ? (float) (10.0 * std::log10 (referenceSquares / errorSquares)) : 200.0f;
+        return result;
+    }
+
+    //==============================================================================
+    bool writeWav (const juce::File& file, const juce::AudioBuffer<float>& buffer)
+    {
+        file.deleteFile();
+        auto stream = file.createOutputStream();
+
+        if (stream == nullptr)
+            return false;
+
+        juce::WavAudioFormat format;
+        std::unique_ptr<juce::AudioFormatWriter> writer (format.createWriterFor (stream.get(), sampleRate, (unsigned int) numChannels,
+                                                                                 32, {}, 0));
+        if (writer == nullptr)
+            return false;
+
+        stream.release();   // now owned by the writer
+        return writer->writeFromAudioSampleBuffer (buffer, 0, buffer.getNumSamples());
+    }
+
+    bool readWav (const juce::File& file, juce::AudioBuffer<float>& buffer)
+    {
+        if (! file.existsAsFile())
+            return false;
+
+        juce::WavAudioFormat format;
+        std::unique_ptr<juce::AudioFormatReader> reader (format.createReaderFor (file.createInputStream().release(), true));
+
+        if (reader == nullptr || (int) reader->numChannels != numChannels)
+            return false;
+
+        buffer.setSize (numChannels, (int) reader->lengthInSamples);
+        reader->read (&buffer, 0, buffer.getNumSamples(), 0, true, true);
+        return true;
+    }
+
+    //==============================================================================
+    struct GoldenCase
+    {
+        juce::String name;
+        Settings settings;
+        std::function<Settings (float)> automation;
+    };
+
+    std::vector<GoldenCase> createCases()
+    {
+        std::vector<GoldenCase> cases;
+
+        for (const auto& preset : factoryPresets)
+            cases.push_back ({ juce::String ("preset_") + preset.name, { preset.smoosh, preset.inputGain, preset.outputGain, 100.0f }, {} });
+
+        // Smoosh automated across both regions, crossing the hammer boundary
+        cases.push_back ({ "sweep_smoosh", { 0.0f, 12.0f, 0.0f, 100.0f },
+                           [] (float position) { return Settings { position * 100.0f, 12.0f, 0.0f, 100.0f }; } });
+
+        // Gains and mix automated at a fixed Smoosh
+        cases.push_back ({ "sweep_gain_mix", { 50.0f, 0.0f, -12.0f, 100.0f },
+                           [] (float position) { return Settings { 50.0f, position * 30.0f, position * 24.0f - 12.0f, 100.0f - position * 100.0f }; } });
+
+        return cases;
+    }
+
+    // Reference file names: lower case, anything but letters and digits as '_'
+    juce::String toFileName (const juce::String& name)
+    {
+        juce::String result;
+
+        for (auto c : name.toLowerCase())
+            result += juce::CharacterFunctions::isLetterOrDigit (c) ? juce::String::charToString (c) : juce::String ("_");
+
+        return result + ".wav";
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::ArgumentList args (argc, argv);
+    Tolerances tolerances;
+
+    if (args.containsOption ("--max-abs"))
+        tolerances.maxAbs = args.getValueForOption ("--max-abs").getFloatValue();
+
+    if (args.containsOption ("--max-rms"))
+        tolerances.maxRms = args.getValueForOption ("--max-rms").getFloatValue();
+
+    if (args.containsOption ("--min-null"))
+        tolerances.minNullDb = args.getValueForOption ("--min-null").getFloatValue();
+
+    const auto referenceDirectory = args.containsOption ("--ref-dir")
+                                      ? juce::File::getCurrentWorkingDirectory().getChildFile (args.getValueForOption ("--ref-dir"))
+                                      : juce::File (SMOOSHER_GOLDEN_DIR);
+
+    juce::File outputDirectory;
+
+    if (args.containsOption ("--out-dir"))
+    {
+        outputDirectory = juce::File::getCurrentWorkingDirectory().getChildFile (args.getValueForOption ("--out-dir"));
+        outputDirectory.createDirectory();
+    }
+
+    const auto input = createTestSignal();
+    const auto cases = createCases();
+
+    //==============================================================================
+    if (args.containsOption ("--update"))
+    {
+        referenceDirectory.createDirectory();
+        DSPKernels::setInstructionSet (DSPKernels::InstructionSet::baseline);
+
+        for (const auto& c : cases)
+        {
+            const auto file = referenceDirectory.getChildFile (toFileName (c.name));
+
+            if (! writeWav (file, render (input, c.settings, referenceBlockSize, c.automation)))
+            {
+                std::cerr << "Can't write " << file.getFullPathName() << "\n";
+                return 1;
+            }
+
+            std::cout << "Updated " << file.getFullPathName() << "\n";
+        }
+
+        return 0;
+    }
+
+    //==============================================================================
+    std::cout << "Tolerances: max abs " << tolerances.maxAbs << ", RMS " << tolerances.maxRms
+              << ", null depth >= " << tolerances.minNullDb << " dB\n\n";
+
+    int numFailures = 0, numMissing = 0;
+
+    auto check = [&] (const juce::String& label, const juce::AudioBuffer<float>& actual, const juce::AudioBuffer<float>& reference)
+    {
+        if (actual.getNumSamples() != reference.getNumSamples())
+        {
+            std::cout << "  FAIL  " << label << ": reference has a different length, regenerate it with --update\n";
+            ++numFailures;
+            return;
+        }
+
+        const auto result = compare (actual, reference);
+        const auto passed = result.passes (tolerances);
+
+        std::cout << (passed ? "  ok    " : "  FAIL  ") << label.paddedRight (' ', 48)
+                  << " max " << juce::String (result.maxAbs, 8)
+                  << "  rms " << juce::String (result.rms, 9)
+                  << "  null " << juce::String (result.nullDb, 1) << " dB\n";
+
+        if (! passed)
+        {
+            ++numFailures;
+
+            if (outputDirectory != juce::File())
+                writeWav (outputDirectory.getChildFile (toFileName (label)), actual);
+        }
+    };
+
+    for (const auto& c : cases)
+    {
+        juce::AudioBuffer<float> reference;
+
+        if (! readWav (referenceDirectory.getChildFile (toFileName (c.name)), reference))
+        {
+            std::cout << "  missing reference for " << c.name << "\n";
+            ++numMissing;
+            continue;
+        }
+
+        for (auto isa : { DSPKernels::InstructionSet::baseline, DSPKernels::InstructionSet::avx2, DSPKernels::InstructionSet::avx512 })
+        {
+            if (! DSPKernels::setInstructionSet (isa))
+                continue;
+
+            const auto label = c.name + " [" + DSPKernels::getName (isa) + "]";
+            check (label, render (input, c.settings, referenceBlockSize, c.automation), reference);
+
+            // With static settings the output must not depend on how the host splits blocks
+            if (! c.automation)
+                check (label + " block 61", render (input, c.settings, 61), reference);
+        }
+
+        // Double precision only differs from float by rounding, far inside tolerance
+        check (c.name + " [double]", render<double> (input, c.settings, referenceBlockSize, c.automation), reference);
+    }
+
+    std::cout << "\n";
+
+    if (numFailures > 0 || numMissing > 0)
+    {
+        std::cout << numFailures << " renders outside tolerance, " << numMissing << " references missing\n";
+
+        if (numMissing > 0)
+            std::cout << "References are read from " << referenceDirectory.getFullPathName()
+                      << ", run with --update on a known-good build to create missing ones\n";
+
+        return 1;
+    }
+
+    std::cout << "All renders within tolerance\n";
+    return 0;
+}
@@ -0,0 +1,439 @@
+#include <JuceHeader.h>
+#include "../Source/PluginProcessor.h"
+#include "../Source/FactoryPresets.h"
+
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <unistd.h>
+#include <cstdarg>
+#include <ctime>
+
+//==============================================================================
+// Real-time safety test (Linux / glibc).
+//
+// The executable interposes the allocator (malloc, free and friends), mutex
+// and condition variable locking, and common blocking syscalls (file and
+// console I/O, sleeping, polling). While processBlock runs, any call to one of
+// them from the audio thread is reported with a stack trace and the test fails.
+// Everything else (prepareToPlay, state changes, parameter changes from the
+// "host" side) is allowed to do whatever it likes.
+//
+// Calls that glibc makes internally (e.g. the write inside printf) don't go
+// through these symbols, so the blocking wrappers cover the public entry points
+// as well: fopen, fwrite, fflush, puts and printf.
+namespace RealtimeChecker
+{
+    // True on the audio thread while processBlock runs
+    static thread_local bool active = false;
+
+    static std::atomic<int> numViolations { 0 };
+    static const char* currentScenario = "";
+    constexpr int maxReports = 20;
+
+    // Reports a forbidden call. Reporting itself writes and may allocate,
+    // so the check is switched off while it runs.
+    void check (const char* function) noexcept
+    {
+        if (! active)
+            return;
+
+        active = false;
+
+        if (++numViolations <= maxReports)
+        {
+            std::fprintf (stderr, "\nReal-time violation: %s() during processBlock [%s]\n", function, currentScenario);
+
+            void* frames[64];
+            const auto numFrames = backtrace (frames, 64);
+            backtrace_symbols_fd (frames, numFrames, STDERR_FILENO);
+        }
+
+        active = true;
+    }
+
+    struct ScopedAudioThread
+    {
+        ScopedAudioThread() noexcept   { active = true; }
+        ~ScopedAudioThread() noexcept  { active = false; }
+    };
+
+    template <typename Function>
+    Function* resolve (Function*& real, const char* name) noexcept
+    {
+        if (real == nullptr)
+            real = reinterpret_cast<Function*> (dlsym (RTLD_NEXT, name));
+
+        return real;
+    }
+}
+
+//==============================================================================
+// Allocator: glibc exports its implementation under __libc_* names, which
+// avoids dlsym (which allocates) while the hooks are being resolved.
+extern "C"
+{
+    void* __libc_malloc (size_t);
+    void* __libc_calloc (size_t, size_t);
+    void* __libc_realloc (void*, size_t);
+    void* __libc_memalign (size_t, size_t);
+    void __libc_free (void*);
+
+    void* malloc (size_t size) noexcept
+    {
+        RealtimeChecker::check ("malloc");
+        return __libc_malloc (size);
+    }
+
+    void* calloc (size_t count, size_t size) noexcept
+    {
+        RealtimeChecker::check ("calloc");
+        return __libc_calloc (count, size);
+    }
+
+    void* realloc (void* ptr, size_t size) noexcept
+    {
+        RealtimeChecker::check ("realloc");
+        return __libc_realloc (ptr, size);
+    }
+
+    void free (void* ptr) noexcept
+    {
+        if (ptr != nullptr)
+            RealtimeChecker::check ("free");
+
+        __libc_free (ptr);
+    }
+
+    void* memalign (size_t alignment, size_t size) noexcept
+    {
+        RealtimeChecker::check ("memalign");
+        return __libc_memalign (alignment, size);
+    }
+
+    void* aligned_alloc (size_t alignment, size_t size) noexcept
+    {
+        RealtimeChecker::check ("aligned_alloc");
+        return __libc_memalign (alignment, size);
+    }
+
+    int posix_memalign (void** result, size_t alignment, size_t size) noexcept
+    {
+        RealtimeChecker::check ("posix_memalign");
+        *result = __libc_memalign (alignment, size);
+        return *result != nullptr ? 0 : ENOMEM;
+    }
+}
+
+//==============================================================================
+// Locks and blocking calls, forwarded to the next definition (libc/libpthread).
+// The real functions are looked up during static initialisation, before any
+// audio thread exists; the lazy lookup only covers calls from earlier
+// initialisers.
+#define SMOOSHER_INTERPOSE(returnType, name, parameters, arguments, ...)                      \
+    namespace RealtimeChecker { static returnType (*real_##name) parameters = nullptr; }    \
+    extern "C" returnType name parameters __VA_ARGS__                                        \
+    {                                                                                        \
+        RealtimeChecker::check (#name);                                                      \
+        return RealtimeChecker::resolve (RealtimeChecker::real_##name, #name) arguments;     \
+    }                                                                                        \
+    static const auto resolved_##name = RealtimeChecker::resolve (RealtimeChecker::real_##name, #name);
+
+SMOOSHER_INTERPOSE (int, pthread_mutex_lock, (pthread_mutex_t* m), (m), noexcept)
+SMOOSHER_INTERPOSE (int, pthread_mutex_timedlock, (pthread_mutex_t* m, const struct timespec* t), (m, t), noexcept)
+SMOOSHER_INTERPOSE (int, pthread_rwlock_rdlock, (pthread_rwlock_t* l), (l), noexcept)
+SMOOSHER_INTERPOSE (int, pthread_rwlock_wrlock, (pthread_rwlock_t* l), (l), noexcept)
+SMOOSHER_INTERPOSE (int, pthread_cond_wait, (pthread_cond_t* c, pthread_mutex_t* m), (c, m))
+SMOOSHER_INTERPOSE (int, pthread_cond_timedwait, (pthread_cond_t* c, pthread_mutex_t* m, const struct timespec* t), (c, m, t))
+SMOOSHER_INTERPOSE (int, pthread_join, (pthread_t t, void** r), (t, r))
+SMOOSHER_INTERPOSE (int, sem_wait, (sem_t* s), (s))
+
+SMOOSHER_INTERPOSE (ssize_t, read, (int fd, void* buffer, size_t size), (fd, buffer, size))
+SMOOSHER_INTERPOSE (ssize_t, write, (int fd, const void* buffer, size_t size), (fd, buffer, size))
+SMOOSHER_INTERPOSE (int, close, (int fd), (fd))
+SMOOSHER_INTERPOSE (FILE*, fopen, (const char* path, const char* mode), (path, mode))
+SMOOSHER_INTERPOSE (size_t, fwrite, (const void* data, size_t size, size_t count, FILE* file), (data, size, count, file))
+SMOOSHER_INTERPOSE (int, fflush, (FILE* file), (file))
+SMOOSHER_INTERPOSE (int, puts, (const char* text), (text))
+SMOOSHER_INTERPOSE (int, usleep, (useconds_t microseconds), (microseconds))
+SMOOSHER_INTERPOSE (unsigned int, sleep, (unsigned int seconds), (seconds))
+SMOOSHER_INTERPOSE (int, nanosleep, (const struct timespec* duration, struct timespec* remaining), (duration, remaining))
+SMOOSHER_INTERPOSE (int, poll, (struct pollfd* fds, nfds_t count, int timeout), (fds, count, timeout))
+SMOOSHER_INTERPOSE (void*, mmap, (void* address, size_t length, int protection, int flags, int fd, off_t offset),
+                    (address, length, protection, flags, fd, offset), noexcept)
+SMOOSHER_INTERPOSE (int, munmap, (void* address, size_t length), (address, length), noexcept)
+
+#undef SMOOSHER_INTERPOSE
+
+// open and printf are variadic, so they get written out by hand
+namespace RealtimeChecker
+{
+    static int (*real_open) (const char*, int, ...) = nullptr;
+    static int (*real_vprintf) (const char*, va_list) = nullptr;
+}
+
+extern "C" int open (const char* path, int flags, ...)
+{
+    RealtimeChecker::check ("open");
+
+    mode_t mode = 0;
+
+    if ((flags & O_CREAT) != 0)
+    {
+        va_list args;
+        va_start (args, flags);
+        mode = (mode_t) va_arg (args, int);
+        va_end (args);
+    }
+
+    return RealtimeChecker::resolve (RealtimeChecker::real_open, "open") (path, flags, mode);
+}
+
+extern "C" int printf (const char* format, ...)
+{
+    RealtimeChecker::check ("printf");
+
+    va_list args;
+    va_start (args, format);
+    const auto result = RealtimeChecker::resolve (RealtimeChecker::real_vprintf, "vprintf") (format, args);
+    va_end (args);
+    return result;
+}
+
+//==============================================================================
+namespace
+{
+    constexpr double defaultSampleRate = 48000.0;
+
+    void setParameter (SmoosherAudioProcessor& processor, const char* id, float value)
+    {
+        auto* parameter = processor.getAPVTS().getParameter (id);
+        parameter->setValueNotifyingHost (parameter->convertTo0to1 (value));
+    }
+
+    void prepare (SmoosherAudioProcessor& processor, int numChannels, double sampleRate, int blockSize)
+    {
+        const auto channelSet = juce::AudioChannelSet::canonicalChannelSet (numChannels);
+        processor.setBusesLayout ({ { channelSet, juce::AudioChannelSet::disabled() }, { channelSet } });
+        processor.setRateAndBufferSizeDetails (sampleRate, blockSize);
+        processor.prepareToPlay (sampleRate, blockSize);
+    }
+
+    // Calls processBlock `numBlocks` times on noise, with the checker armed
+    // only around the call itself. `betweenBlocks` plays the host: it runs
+    // before each block, unchecked.
+    template <typename SampleType>
+    void processBlocks (SmoosherAudioProcessor& processor, juce::AudioBuffer<SampleType>& buffer, int numBlocks,
+                        const std::function<void (int)>& betweenBlocks = {})
+    {
+        juce::MidiBuffer midi;
+        juce::Random random (42);
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            if (betweenBlocks)
+                betweenBlocks (block);
+
+            for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+                for (int i = 0; i < buffer.getNumSamples(); ++i)
+                    buffer.setSample (channel, i, (SampleType) ((random.nextFloat() * 2.0f - 1.0f) * 0.7f));
+
+            const RealtimeChecker::ScopedAudioThread audioThread;
+            processor.processBlock (buffer, midi);
+        }
+    }
+
+    //==============================================================================
+    void runScenarios()
+    {
+        using RealtimeChecker::currentScenario;
+
+        SmoosherAudioProcessor processor;
+
+        currentScenario = "steady state, every preset";
+        {
+            prepare (processor, 2, defaultSampleRate, 512);
+            juce::AudioBuffer<float> buffer (2, 512);
+
+            for (const auto& preset : factoryPresets)
+            {
+                setParameter (processor, "smoosh", preset.smoosh);
+                setParameter (processor, "inputGain", preset.inputGain);
+                setParameter (processor, "outputGain", preset.outputGain);
+                processBlocks (processor, buffer, 50);
+            }
+        }
+
+        currentScenario = "parameter automation every block";
+        {
+            juce::AudioBuffer<float> buffer (2, 256);
+
+            processBlocks (processor, buffer, 400, [&] (int block)
+            {
+                const auto position = (float) (block % 100) / 100.0f;
+                setParameter (processor, "smoosh", position * 100.0f);
+                setParameter (processor, "inputGain", position * 30.0f);
+                setParameter (processor, "outputGain", 12.0f - position * 24.0f);
+                setParameter (processor, "mix", 100.0f - position * 50.0f);
+            });
+        }
+
+        currentScenario = "block size changes without re-preparing";
+        {
+            // Hosts may send any size up to the prepared one, and some send more
+            for (auto blockSize : { 1, 17, 64, 512, 333, 2048, 8192 })
+            {
+                juce::AudioBuffer<float> buffer (2, blockSize);
+                processBlocks (processor, buffer, 8);
+            }
+        }
+
+        currentScenario = "block size and sample rate changes";
+        {
+            for (auto [sampleRate, blockSize] : { std::pair { 44100.0, 32 }, std::pair { 96000.0, 1024 }, std::pair { 192000.0, 4096 } })
+            {
+                prepare (processor, 2, sampleRate, blockSize);
+                juce::AudioBuffer<float> buffer (2, blockSize);
+                processBlocks (processor, buffer, 20);
+            }
+        }
+
+        currentScenario = "channel count changes";
+        {
+            for (auto numChannels : { 1, 2, 6, 12, 24, 1 })
+            {
+                prepare (processor, numChannels, defaultSampleRate, 512);
+                juce::AudioBuffer<float> buffer (numChannels, 512);
+                processBlocks (processor, buffer, 20);
+            }
+        }
+
+        currentScenario = "state reloads between blocks";
+        {
+            prepare (processor, 2, defaultSampleRate, 512);
+            juce::AudioBuffer<float> buffer (2, 512);
+
+            juce::MemoryBlock state;
+            setParameter (processor, "smoosh", 80.0f);
+            processor.getStateInformation (state);
+            setParameter (processor, "smoosh", 20.0f);
+
+            processBlocks (processor, buffer, 40, [&] (int block)
+            {
+                if (block % 10 == 5)
+                    processor.setStateInformation (state.getData(), (int) state.getSize());
+            });
+        }
+
+        currentScenario = "sidechain key";
+        {
+            const auto stereo = juce::AudioChannelSet::stereo();
+            processor.setBusesLayout ({ { stereo, juce::AudioChannelSet::mono() }, { stereo } });
+            processor.setRateAndBufferSizeDetails (defaultSampleRate, 512);
+            processor.prepareToPlay (defaultSampleRate, 512);
+            juce::AudioBuffer<float> buffer (3, 512);
+
+            processBlocks (processor, buffer, 60, [&] (int block)
+            {
+                setParameter (processor, "keySource", (float) ((block / 20) % 3));
+                setParameter (processor, "link", (float) ((block / 10) % 2));
+            });
+
+            setParameter (processor, "keySource", 0.0f);
+        }
+
+        currentScenario = "multiband";
+        {
+            for (auto numChannels : { 1, 2, 6 })
+            {
+                prepare (processor, numChannels, defaultSampleRate, 512);
+                juce::AudioBuffer<float> buffer (numChannels, 512);
+
+                processBlocks (processor, buffer, 60, [&] (int block)
+                {
+                    setParameter (processor, "bands", (float) ((block / 10) % 3));
+                    setParameter (processor, "link", (float) ((block / 15) % 2));
+                    setParameter (processor, "lowCrossover", 100.0f + (float) (block % 20) * 20.0f);
+                    setParameter (processor, "highCrossover", 2000.0f + (float) (block % 20) * 200.0f);
+                });
+            }
+
+            setParameter (processor, "bands", 0.0f);
+        }
+
+        currentScenario = "control rate";
+        {
+            setParameter (processor, "controlRate", 1.0f);
+
+            for (auto numChannels : { 2, 6 })
+            {
+                prepare (processor, numChannels, defaultSampleRate, 512);
+                juce::AudioBuffer<float> buffer (numChannels, 512);
+
+                processBlocks (processor, buffer, 60, [&] (int block)
+                {
+                    setParameter (processor, "smoosh", (float) (block % 50) * 2.0f);
+                    setParameter (processor, "bands", (float) ((block / 10) % 3));
+                    setParameter (processor, "link", (float) ((block / 15) % 2));
+                });
+            }
+
+            setParameter (processor, "bands", 0.0f);
+            setParameter (processor, "controlRate", 0.0f);
+        }
+
+        currentScenario = "real-time playback after preparing for a bounce";
+        {
+            // Prepared with a thread pool, which playback mustn't wait on
+            processor.setNonRealtime (true);
+            prepare (processor, 12, defaultSampleRate, 512);
+            processor.setNonRealtime (false);
+
+            juce::AudioBuffer<float> buffer (12, 512);
+            processBlocks (processor, buffer, 40);
+        }
+
+        currentScenario = "double precision";
+        {
+            processor.setProcessingPrecision (juce::AudioProcessor::doublePrecision);
+            prepare (processor, 2, defaultSampleRate, 512);
+            juce::AudioBuffer<double> buffer (2, 512);
+
+            processBlocks (processor, buffer, 100, [&] (int block)
+            {
+                setParameter (processor, "smoosh", (float) (block % 50) * 2.0f);
+                setParameter (processor, "link", (float) ((block / 25) % 2));
+            });
+
+            processor.setProcessingPrecision (juce::AudioProcessor::singlePrecision);
+        }
+
+        processor.releaseResources();
+    }
+}
+
+//==============================================================================
+int main()
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    // backtrace() loads libgcc on first use, which allocates
+    void* frames[4];
+    backtrace (frames, 4);
+
+    runScenarios();
+
+    const auto violations = RealtimeChecker::numViolations.load();
+
+    if (violations > 0)
+    {
+        std::fprintf (stderr, "\n%d real-time violations during processBlock\n", violations);
+        return 1;
+    }
+
+    std::fprintf (stdout, "No allocations, locks or blocking calls during processBlock\n");
+    return 0;
+}
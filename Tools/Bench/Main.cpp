@@ -0,0 +1,438 @@
+#include <JuceHeader.h>
+#include "../../Source/PluginProcessor.h"
+#include "../../Source/SmoosherBatch.h"
+
+#include <thread>
+
+#if defined (__x86_64__) || defined (_M_X64) || defined (__i386__) || defined (_M_IX86)
+ #if defined (_MSC_VER)
+  #include <intrin.h>
+ #else
+  #include <x86intrin.h>
+ #endif
+ #define SMOOSHER_BENCH_HAS_TSC 1
+#else
+ #define SMOOSHER_BENCH_HAS_TSC 0
+#endif
+
+//==============================================================================
+// smoosher_bench: times SmoosherAudioProcessor::processBlock over a matrix of
+// block sizes, sample rates, channel counts and Smoosh regions, and prints the
+// results as JSON or CSV so they can be tracked across commits.
+//
+// Each case processes `--seconds` of white noise per run, `--repeats` times,
+// and reports the fastest run. Times are per sample frame (all channels).
+// Cycles come from the time stamp counter on x86 (reference cycles, which
+// differ from core cycles while the CPU boosts) and are omitted elsewhere.
+//
+// With --streams, each case runs that many streams through SmoosherBatch
+// instead (on --threads worker threads), and times are per sample frame of
+// one stream, to compare with the single-processor cost.
+namespace
+{
+    struct Region
+    {
+        const char* name;
+        float smoosh;
+    };
+
+    // One point inside each region of the Smoosh curve
+    constexpr Region regions[] = { { "bypass", 0.0f }, { "normal", 35.0f }, { "hammer", 80.0f } };
+
+    struct Case
+    {
+        int blockSize;
+        double sampleRate;
+        int numChannels;
+        Region region;
+        int numBands;
+        bool controlRate;
+        int numStreams;     // 0 = one SmoosherAudioProcessor
+        int numThreads;
+    };
+
+    struct Result
+    {
+        Case config;
+        double nsPerSample;
+        double cyclesPerSample;   // negative if there is no cycle counter
+    };
+
+    struct Options
+    {
+        juce::Array<int> blockSizes { 16, 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+        juce::Array<double> sampleRates { 44100.0, 48000.0, 88200.0, 96000.0, 192000.0 };
+        juce::Array<int> channelCounts { 1, 2, 12 };   // 12 = a 7.1.4 bed
+        int numBands = 1;                              // 1 = multiband off
+        bool controlRate = false;
+        int numStreams = 0;                            // 0 = plugin processor, not SmoosherBatch
+        int numThreads = 1;
+        double seconds = 2.0;
+        int repeats = 5;
+        bool csv = false;
+        juce::File outputFile;
+    };
+
+    std::uint64_t readCycleCounter() noexcept
+    {
+       #if SMOOSHER_BENCH_HAS_TSC
+        return (std::uint64_t) __rdtsc();
+       #else
+        return 0;
+       #endif
+    }
+
+    void printUsage()
+    {
+        std::cout << "Usage: smoosher_bench [options]\n"
+                     "\n"
+                     "Options:\n"
+                     "  --format <json|csv>    Output format (default: json)\n"
+                     "  --out <file>           Write results to a file instead of stdout\n"
+                     "  --seconds <s>          Audio processed per run (default: 2)\n"
+                     "  --repeats <n>          Runs per case, fastest is reported (default: 5)\n"
+                     "  --quick                Block sizes 64/512/4096, 48 kHz only, one run\n"
+                     "  --bands <n>            Multiband mode with 2 or 3 bands (default: off)\n"
+                     "  --control-rate         Gain computer at the control rate (not with --streams)\n"
+                     "  --streams <n>          Time n streams in SmoosherBatch instead of one processor\n"
+                     "  --threads <n>          Worker threads for --streams (default: 1)\n"
+                     "  --isa <name>           Force DSP kernels: sse2, neon, avx2 or avx512\n";
+    }
+
+    //==============================================================================
+    Result runCase (const Case& config, const Options& options)
+    {
+        SmoosherAudioProcessor processor;
+
+        auto set = [&processor] (const char* id, float value)
+        {
+            auto* parameter = processor.getAPVTS().getParameter (id);
+            parameter->setValueNotifyingHost (parameter->convertTo0to1 (value));
+        };
+
+        set ("smoosh", config.region.smoosh);
+        set ("inputGain", 12.0f);
+        set ("outputGain", 0.0f);
+        set ("mix", 100.0f);
+        set ("bands", (float) (config.numBands - 1));
+        set ("controlRate", config.controlRate ? 1.0f : 0.0f);
+
+        const auto channelSet = juce::AudioChannelSet::canonicalChannelSet (config.numChannels);
+        processor.setBusesLayout ({ { channelSet, juce::AudioChannelSet::disabled() }, { channelSet } });
+        processor.setRateAndBufferSizeDetails (config.sampleRate, config.blockSize);
+        processor.prepareToPlay (config.sampleRate, config.blockSize);
+
+        // One second of noise, copied into the block buffer before each call
+        // because processBlock works in place
+        const auto sourceLength = juce::roundToInt (config.sampleRate);
+        juce::AudioBuffer<float> source (config.numChannels, sourceLength);
+        juce::Random random (1234);
+
+        for (int channel = 0; channel < config.numChannels; ++channel)
+            for (int sample = 0; sample < sourceLength; ++sample)
+                source.setSample (channel, sample, (random.nextFloat() * 2.0f - 1.0f) * 0.5f);
+
+        juce::AudioBuffer<float> block (config.numChannels, config.blockSize);
+        juce::MidiBuffer midi;
+        int sourcePosition = 0;
+
+        auto processBlocks = [&] (int numBlocks)
+        {
+            for (int i = 0; i < numBlocks; ++i)
+            {
+                if (sourcePosition + config.blockSize > sourceLength)
+                    sourcePosition = 0;
+
+                for (int channel = 0; channel < config.numChannels; ++channel)
+                    block.copyFrom (channel, 0, source, channel, sourcePosition, config.blockSize);
+
+                sourcePosition += config.blockSize;
+                processor.processBlock (block, midi);
+            }
+        };
+
+        const auto numBlocks = juce::jmax (1, juce::roundToInt (options.seconds * config.sampleRate / config.blockSize));
+        const auto numSamples = (double) numBlocks * config.blockSize;
+
+        // Warm up caches, branch predictors and the smoothers
+        processBlocks (juce::jmax (1, numBlocks / 4));
+
+        Result result { config, std::numeric_limits<double>::max(), -1.0 };
+
+        for (int run = 0; run < options.repeats; ++run)
+        {
+            const auto startTicks = juce::Time::getHighResolutionTicks();
+            const auto startCycles = readCycleCounter();
+
+            processBlocks (numBlocks);
+
+            const auto cycles = (double) (readCycleCounter() - startCycles);
+            const auto seconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks);
+            const auto nsPerSample = seconds * 1.0e9 / numSamples;
+
+            if (nsPerSample < result.nsPerSample)
+            {
+                result.nsPerSample = nsPerSample;
+                result.cyclesPerSample = SMOOSHER_BENCH_HAS_TSC ? cycles / numSamples : -1.0;
+            }
+        }
+
+        processor.releaseResources();
+        return result;
+    }
+
+    //==============================================================================
+    Result runBatchCase (const Case& config, const Options& options)
+    {
+        SmoosherBatch batch;
+        batch.prepare (config.sampleRate, config.blockSize, config.numStreams, config.numChannels, config.numThreads);
+
+        SmoosherBatch::Parameters parameters;
+        parameters.smoosh = config.region.smoosh;
+        parameters.inputGainDb = 12.0f;
+
+        for (int stream = 0; stream < config.numStreams; ++stream)
+        {
+            batch.setParameters (stream, parameters);
+            batch.resetStream (stream);
+        }
+
+        // One second of noise, which each stream reads from its own offset
+        const auto sourceLength = juce::roundToInt (config.sampleRate);
+        const auto numChannels = config.numStreams * config.numChannels;
+        juce::AudioBuffer<float> source (config.numChannels, sourceLength);
+        juce::Random random (1234);
+
+        for (int channel = 0; channel < config.numChannels; ++channel)
+            for (int sample = 0; sample < sourceLength; ++sample)
+                source.setSample (channel, sample, (random.nextFloat() * 2.0f - 1.0f) * 0.5f);
+
+        juce::AudioBuffer<float> block (numChannels, config.blockSize);
+        auto* const* channels = block.getArrayOfWritePointers();
+        const auto* const* sourceChannels = source.getArrayOfReadPointers();
+
+        // Streams are independent, so each thread takes a range of lane groups
+        // through the whole run without waiting for the others. The threads
+        // share both buffers, so they only touch them through the raw pointers
+        // taken above (AudioBuffer's own methods update its isClear flag).
+        auto processBlocks = [&] (int worker, int numBlocks)
+        {
+            const auto numGroups = batch.getNumGroups();
+            const auto firstGroup = numGroups * worker / config.numThreads;
+            const auto lastGroup = numGroups * (worker + 1) / config.numThreads;
+            const auto firstChannel = juce::jmin (numChannels, firstGroup * batch.getStreamsPerGroup() * config.numChannels);
+            const auto lastChannel = juce::jmin (numChannels, lastGroup * batch.getStreamsPerGroup() * config.numChannels);
+
+            for (int i = 0; i < numBlocks; ++i)
+            {
+                for (int channel = firstChannel; channel < lastChannel; ++channel)
+                {
+                    const auto offset = ((channel / config.numChannels) * 997 + i * config.blockSize) % (sourceLength - config.blockSize);
+                    juce::FloatVectorOperations::copy (channels[channel], sourceChannels[channel % config.numChannels] + offset,
+                                                       config.blockSize);
+                }
+
+                batch.processGroups (worker, firstGroup, lastGroup - firstGroup, channels, config.blockSize);
+            }
+        };
+
+        auto processOnAllThreads = [&] (int numBlocks)
+        {
+            std::vector<std::thread> threads;
+
+            for (int worker = 1; worker < config.numThreads; ++worker)
+                threads.emplace_back (processBlocks, worker, numBlocks);
+
+            processBlocks (0, numBlocks);
+
+            for (auto& thread : threads)
+                thread.join();
+        };
+
+        const auto numBlocks = juce::jmax (1, juce::roundToInt (options.seconds * config.sampleRate / config.blockSize));
+        const auto numSamples = (double) numBlocks * config.blockSize * config.numStreams;
+
+        processOnAllThreads (juce::jmax (1, numBlocks / 4));
+
+        Result result { config, std::numeric_limits<double>::max(), -1.0 };
+
+        for (int run = 0; run < options.repeats; ++run)
+        {
+            const auto startTicks = juce::Time::getHighResolutionTicks();
+            const auto startCycles = readCycleCounter();
+
+            processOnAllThreads (numBlocks);
+
+            const auto cycles = (double) (readCycleCounter() - startCycles);
+            const auto seconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks);
+            const auto nsPerSample = seconds * 1.0e9 / numSamples;
+
+            if (nsPerSample < result.nsPerSample)
+            {
+                result.nsPerSample = nsPerSample;
+                result.cyclesPerSample = SMOOSHER_BENCH_HAS_TSC ? cycles / numSamples : -1.0;
+            }
+        }
+
+        return result;
+    }
+
+    //==============================================================================
+    juce::String toJson (const std::vector<Result>& results)
+    {
+        juce::String json;
+        json << "{\n"
+             << "  \"cpu\": " << juce::JSON::toString (juce::SystemStats::getCpuModel()) << ",\n"
+             << "  \"isa\": \"" << DSPKernels::getName (DSPKernels::getInstructionSet()) << "\",\n"
+
+             << "  \"results\": [\n";
+
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const auto& r = results[i];
+            json << "    { \"blockSize\": " << r.config.blockSize
+                 << ", \"sampleRate\": " << r.config.sampleRate
+                 << ", \"channels\": " << r.config.numChannels
+                 << ", \"region\": \"" << r.config.region.name << "\""
+                 << ", \"smoosh\": " << r.config.region.smoosh
+                 << ", \"bands\": " << r.config.numBands
+                 << ", \"controlRate\": " << (r.config.controlRate ? "true" : "false")
+                 << ", \"streams\": " << juce::jmax (1, r.config.numStreams)
+                 << ", \"threads\": " << r.config.numThreads
+                 << ", \"nsPerSample\": " << juce::String (r.nsPerSample, 3)
+                 << ", \"cyclesPerSample\": " << (r.cyclesPerSample < 0.0 ? juce::String ("null") : juce::String (r.cyclesPerSample, 2))
+                 << " }" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+
+        json << "  ]\n}\n";
+        return json;
+    }
+
+    juce::String toCsv (const std::vector<Result>& results)
+    {
+        juce::String csv ("blockSize,sampleRate,channels,region,smoosh,bands,controlRate,streams,threads,nsPerSample,cyclesPerSample,isa\n");
+        const juce::String isa (DSPKernels::getName (DSPKernels::getInstructionSet()));
+
+        for (const auto& r : results)
+            csv << r.config.blockSize << "," << r.config.sampleRate << "," << r.config.numChannels << ","
+                << r.config.region.name << "," << r.config.region.smoosh << "," << r.config.numBands << ","
+                << (r.config.controlRate ? 1 : 0) << ","
+                << juce::jmax (1, r.config.numStreams) << "," << r.config.numThreads << ","
+                << juce::String (r.nsPerSample, 3) << ","
+                << (r.cyclesPerSample < 0.0 ? juce::String() : juce::String (r.cyclesPerSample, 2)) << ","
+                << isa << "\n";
+
+        return csv;
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::ArgumentList args (argc, argv);
+    Options options;
+
+    if (args.containsOption ("--help|-h"))
+    {
+        printUsage();
+        return 0;
+    }
+
+    if (args.containsOption ("--quick"))
+    {
+        options.blockSizes = { 64, 512, 4096 };
+        options.sampleRates = { 48000.0 };
+        options.seconds = 0.5;
+        options.repeats = 1;
+    }
+
+    if (args.containsOption ("--format"))
+        options.csv = args.getValueForOption ("--format") == "csv";
+
+    if (args.containsOption ("--out"))
+        options.outputFile = juce::File::getCurrentWorkingDirectory().getChildFile (args.getValueForOption ("--out"));
+
+    if (args.containsOption ("--seconds"))
+        options.seconds = args.getValueForOption ("--seconds").getDoubleValue();
+
+    if (args.containsOption ("--repeats"))
+        options.repeats = juce::jmax (1, args.getValueForOption ("--repeats").getIntValue());
+
+    if (args.containsOption ("--bands"))
+        options.numBands = juce::jlimit (1, 3, args.getValueForOption ("--bands").getIntValue());
+
+    if (args.containsOption ("--control-rate"))
+        options.controlRate = true;
+
+    if (args.containsOption ("--streams"))
+        options.numStreams = juce::jmax (1, args.getValueForOption ("--streams").getIntValue());
+
+    if (args.containsOption ("--threads"))
+        options.numThreads = juce::jmax (1, args.getValueForOption ("--threads").getIntValue());
+
+    if (args.containsOption ("--isa"))
+    {
+        const auto name = args.getValueForOption ("--isa");
+        bool found = false;
+
+        for (auto isa : { DSPKernels::InstructionSet::baseline, DSPKernels::InstructionSet::avx2, DSPKernels::InstructionSet::avx512 })
+        {
+            if (name == DSPKernels::getName (isa))
+            {
+                found = true;
+
+                if (! DSPKernels::setInstructionSet (isa))
+                {
+                    std::cerr << name << " is not supported on this CPU\n";
+                    return 1;
+                }
+            }
+        }
+
+        if (! found)
+        {
+            std::cerr << "Unknown instruction set: " << name << "\n";
+            return 1;
+        }
+    }
+
+    std::vector<Result> results;
+
+    for (auto blockSize : options.blockSizes)
+        for (auto sampleRate : options.sampleRates)
+            for (auto numChannels : options.channelCounts)
+                for (const auto& region : regions)
+                {
+                    const Case config { blockSize, sampleRate, numChannels, region, options.numBands, options.controlRate,
+                                       options.numStreams, options.numThreads };
+
+                    // SmoosherBatch streams have no multiband or control-rate mode and at most 16 channels
+                    if (config.numStreams > 0 && (config.numBands > 1 || config.controlRate || numChannels > 16))
+                        continue;
+
+                    results.push_back (config.numStreams > 0 ? runBatchCase (config, options) : runCase (config, options));
+
+                    // Progress goes to stderr so stdout stays machine-readable
+                    std::cerr << "block " << blockSize << ", " << sampleRate << " Hz, " << numChannels << " ch, "
+                              << region.name << ": " << juce::String (results.back().nsPerSample, 2) << " ns/sample\n";
+                }
+
+    const auto report = options.csv ? toCsv (results) : toJson (results);
+
+    if (options.outputFile != juce::File())
+    {
+        if (! options.outputFile.replaceWithText (report))
+        {
+            std::cerr << "Can't write " << options.outputFile.getFullPathName() << "\n";
+            return 1;
+        }
+    }
+    else
+    {
+        std::cout << report;
+    }
+
+    return 0;
+}
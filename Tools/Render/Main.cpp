@@ -0,0 +1,543 @@
+#include <JuceHeader.h>
+#include "../../Source/PluginProcessor.h"
+#include "../../Source/FactoryPresets.h"
+
+//==============================================================================
+// smoosher_render: runs SmoosherAudioProcessor over audio files without a host.
+//
+//   smoosher_render [options] <file>...
+//
+// Files are streamed block by block through the reader and writer, so memory
+// use depends on the block size only, not on the file length. Each worker
+// thread owns one processor and takes the next task from a shared queue: a
+// whole file or, with more than one job, a chunk of a long one. A chunk is
+// rendered to a temporary file after a warm-up on the audio before it, and
+// whichever worker finishes a file's last chunk joins them into the output.
+namespace
+{
+    struct Settings
+    {
+        float smoosh = 0.0f;
+        float inputGain = 0.0f;
+        float outputGain = 0.0f;
+        float mix = 100.0f;
+    };
+
+    struct Options
+    {
+        Settings settings;
+        juce::File outputDirectory;
+        juce::String suffix = ".smooshed";
+        int blockSize = 512;
+        int numJobs = juce::SystemStats::getNumCpus();
+        double chunkSeconds = 60.0;
+        double lookaheadMs = 0.0;
+        juce::Array<juce::File> inputs;
+    };
+
+    // A file to render, in one piece or in chunks of chunkLength samples
+    struct FileJob
+    {
+        juce::File input, output;
+        juce::int64 chunkLength = 0;
+        int numChunks = 1;
+        std::vector<std::unique_ptr<juce::TemporaryFile>> chunkFiles;
+        std::atomic<int> chunksLeft { 1 };
+        std::atomic<bool> failed { false };
+    };
+
+    struct Task
+    {
+        FileJob* file;
+        int chunk;
+    };
+
+    void printUsage()
+    {
+        std::cout << "Usage: smoosher_render [options] <file>...\n"
+                     "\n"
+                     "Options (values may also be given as --option=value, which is\n"
+                     "needed for negative numbers):\n"
+                     "  --preset <name>        Start from a factory preset\n"
+                     "  --smoosh <0-100>       Smoosh amount in %\n"
+                     "  --input <0-30>         Input gain in dB\n"
+                     "  --output <-12-12>      Output gain in dB, e.g. --output=-3\n"
+                     "  --mix <0-100>          Dry/wet mix in %\n"
+                     "  --lookahead <ms>       Render in two passes, with the gain reduction moved\n"
+                     "                         this much ahead of transients, e.g. 2 (default: 0, off)\n"
+                     "  --out-dir <dir>        Write results here (default: next to each input)\n"
+                     "  --suffix <text>        Appended to output file names (default: .smooshed)\n"
+                     "  --block-size <n>       Samples per processBlock call (default: 512)\n"
+                     "  --jobs <n>             Files or chunks processed in parallel (default: CPU count)\n"
+                     "  --chunk-seconds <s>    With more than one job, split longer files into chunks\n"
+                     "                         of this length, 0 to never split (default: 60)\n"
+                     "  --list-presets         Print the factory presets and exit\n";
+    }
+
+    const FactoryPreset* findPreset (const juce::String& name)
+    {
+        for (const auto& preset : factoryPresets)
+            if (name.equalsIgnoreCase (preset.name))
+                return &preset;
+
+        return nullptr;
+    }
+
+    // Parses the command line, or returns an error message
+    juce::String parseOptions (juce::ArgumentList args, Options& options)
+    {
+        if (args.containsOption ("--preset"))
+        {
+            auto name = args.removeValueForOption ("--preset");
+
+            if (auto* preset = findPreset (name))
+            {
+                options.settings.smoosh = preset->smoosh;
+                options.settings.inputGain = preset->inputGain;
+                options.settings.outputGain = preset->outputGain;
+            }
+            else
+            {
+                return "Unknown preset: " + name;
+            }
+        }
+
+        // Explicit values override the preset
+        auto readFloat = [&args] (const char* option, float& value)
+        {
+            if (args.containsOption (option))
+                value = args.removeValueForOption (option).getFloatValue();
+        };
+
+        readFloat ("--smoosh", options.settings.smoosh);
+        readFloat ("--input", options.settings.inputGain);
+        readFloat ("--output", options.settings.outputGain);
+        readFloat ("--mix", options.settings.mix);
+
+        if (args.containsOption ("--lookahead"))
+            options.lookaheadMs = args.removeValueForOption ("--lookahead").getDoubleValue();
+
+        if (args.containsOption ("--out-dir"))
+        {
+            options.outputDirectory = juce::File::getCurrentWorkingDirectory()
+                                          .getChildFile (args.removeValueForOption ("--out-dir"));
+
+            if (! options.outputDirectory.createDirectory())
+                return "Can't create output directory: " + options.outputDirectory.getFullPathName();
+        }
+
+        if (args.containsOption ("--suffix"))
+            options.suffix = args.removeValueForOption ("--suffix");
+
+        if (args.containsOption ("--block-size"))
+            options.blockSize = args.removeValueForOption ("--block-size").getIntValue();
+
+        if (args.containsOption ("--jobs"))
+            options.numJobs = args.removeValueForOption ("--jobs").getIntValue();
+
+        if (args.containsOption ("--chunk-seconds"))
+            options.chunkSeconds = args.removeValueForOption ("--chunk-seconds").getDoubleValue();
+
+        if (options.blockSize <= 0 || options.numJobs <= 0)
+            return "--block-size and --jobs must be positive";
+
+        if (options.chunkSeconds < 0.0 || options.lookaheadMs < 0.0)
+            return "--chunk-seconds and --lookahead can't be negative";
+
+        for (const auto& arg : args.arguments)
+        {
+            if (arg.isOption())
+                return "Unknown option: " + arg.text;
+
+            auto file = arg.resolveAsFile();
+
+            if (! file.existsAsFile())
+                return "No such file: " + file.getFullPathName();
+
+            options.inputs.add (file);
+        }
+
+        if (options.inputs.isEmpty())
+            return "No input files";
+
+        return {};
+    }
+
+    juce::File outputFileFor (const Options& options, const juce::File& input)
+    {
+        auto directory = options.outputDirectory == juce::File() ? input.getParentDirectory()
+                                                                 : options.outputDirectory;
+
+        return directory.getChildFile (input.getFileNameWithoutExtension() + options.suffix + input.getFileExtension());
+    }
+
+    std::unique_ptr<juce::AudioFormatWriter> createWriter (juce::AudioFormat& format, const juce::File& target,
+                                                           const juce::AudioFormatReader& source, int bitsPerSample,
+                                                           const juce::StringPairArray& metadata)
+    {
+        std::unique_ptr<juce::AudioFormatWriter> writer;
+
+        if (auto stream = target.createOutputStream())
+        {
+            writer.reset (format.createWriterFor (stream.get(), source.sampleRate, source.numChannels,
+                                                  bitsPerSample, metadata, 0));
+
+            if (writer != nullptr)
+                stream.release();   // now owned by the writer
+        }
+
+        return writer;
+    }
+
+    //==============================================================================
+    class RenderWorker  : public juce::Thread
+    {
+    public:
+        RenderWorker (const Options& o, const std::vector<Task>& t, std::atomic<int>& next, std::atomic<int>& failures)
+            : juce::Thread ("smoosher_render worker"), options (o), tasks (t), nextTask (next), numFailures (failures)
+        {
+            formatManager.registerBasicFormats();
+
+            auto& apvts = processor.getAPVTS();
+
+            auto set = [&apvts] (const char* id, float value)
+            {
+                auto* parameter = apvts.getParameter (id);
+                parameter->setValueNotifyingHost (parameter->convertTo0to1 (value));
+            };
+
+            set ("smoosh", options.settings.smoosh);
+            set ("inputGain", options.settings.inputGain);
+            set ("outputGain", options.settings.outputGain);
+            set ("mix", options.settings.mix);
+        }
+
+        void run() override
+        {
+            for (int index = nextTask++; index < (int) tasks.size(); index = nextTask++)
+            {
+                const auto& task = tasks[(size_t) index];
+                auto& file = *task.file;
+                auto error = file.numChunks == 1 ? render (file) : renderChunk (file, task.chunk);
+
+                // The last chunk to finish joins them all into the output
+                if (error.isEmpty() && file.numChunks > 1)
+                {
+                    if (--file.chunksLeft > 0 || file.failed)
+                        continue;
+
+                    error = joinChunks (file);
+                }
+
+                if (error.isEmpty())
+                {
+                    log (file.input.getFileName() + " -> " + file.output.getFullPathName());
+                }
+                else if (! file.failed.exchange (true))
+                {
+                    ++numFailures;
+                    log (file.input.getFileName() + ": " + error);
+                }
+            }
+        }
+
+    private:
+        // Opens the input and sets the processor's layout to its channels
+        juce::String openInput (const juce::File& input, std::unique_ptr<juce::AudioFormatReader>& reader)
+        {
+            reader.reset (formatManager.createReaderFor (input));
+
+            if (reader == nullptr)
+                return "unsupported or unreadable file";
+
+            const auto numChannels = (int) reader->numChannels;
+            const auto channelSet = juce::AudioChannelSet::canonicalChannelSet (numChannels);
+
+            if (! processor.setBusesLayout ({ { channelSet, juce::AudioChannelSet::disabled() }, { channelSet } }))
+                return juce::String (numChannels) + " channels are not supported";
+
+            return {};
+        }
+
+        juce::String render (const FileJob& file)
+        {
+            std::unique_ptr<juce::AudioFormatReader> reader;
+            auto error = openInput (file.input, reader);
+
+            if (error.isNotEmpty())
+                return error;
+
+            auto* format = formatManager.findFormatForFileExtension (file.output.getFileExtension());
+
+            if (format == nullptr)
+                return "no writer for " + file.output.getFileExtension();
+
+            // Written to a temporary file first, so a failed render never
+            // leaves a truncated output behind
+            juce::TemporaryFile temporary (file.output);
+            auto writer = createWriter (*format, temporary.getFile(), *reader, (int) reader->bitsPerSample, reader->metadataValues);
+
+            if (writer == nullptr)
+                return "can't write " + file.output.getFullPathName();
+
+            error = process (*reader, *writer, 0, reader->lengthInSamples);
+
+            if (error.isNotEmpty())
+                return error;
+
+            writer.reset();
+
+            if (! temporary.overwriteTargetFileWithTemporary())
+                return "can't replace " + file.output.getFullPathName();
+
+            return {};
+        }
+
+        // One chunk of a long file, into its own temporary file in 32-bit
+        // float so joining the chunks changes nothing
+        juce::String renderChunk (const FileJob& file, int chunk)
+        {
+            std::unique_ptr<juce::AudioFormatReader> reader;
+            auto error = openInput (file.input, reader);
+
+            if (error.isNotEmpty())
+                return error;
+
+            juce::WavAudioFormat wav;
+            auto writer = createWriter (wav, file.chunkFiles[(size_t) chunk]->getFile(), *reader, 32, {});
+
+            if (writer == nullptr)
+                return "can't write a temporary file next to " + file.output.getFullPathName();
+
+            const auto start = chunk * file.chunkLength;
+            return process (*reader, *writer, start, juce::jmin (start + file.chunkLength, reader->lengthInSamples));
+        }
+
+        // Copies the chunks, in order, into the output
+        juce::String joinChunks (const FileJob& file)
+        {
+            std::unique_ptr<juce::AudioFormatReader> source (formatManager.createReaderFor (file.input));
+
+            if (source == nullptr)
+                return "unsupported or unreadable file";
+
+            auto* format = formatManager.findFormatForFileExtension (file.output.getFileExtension());
+
+            if (format == nullptr)
+                return "no writer for " + file.output.getFileExtension();
+
+            juce::TemporaryFile temporary (file.output);
+            auto writer = createWriter (*format, temporary.getFile(), *source, (int) source->bitsPerSample, source->metadataValues);
+
+            if (writer == nullptr)
+                return "can't write " + file.output.getFullPathName();
+
+            juce::WavAudioFormat wav;
+            juce::AudioBuffer<float> buffer ((int) source->numChannels, options.blockSize);
+
+            for (const auto& chunkFile : file.chunkFiles)
+            {
+                std::unique_ptr<juce::AudioFormatReader> chunk (wav.createReaderFor (chunkFile->getFile().createInputStream().release(), true));
+
+                if (chunk == nullptr)
+                    return "can't read back a temporary file";
+
+                for (juce::int64 position = 0; position < chunk->lengthInSamples; position += options.blockSize)
+                {
+                    const auto numSamples = (int) juce::jmin ((juce::int64) options.blockSize, chunk->lengthInSamples - position);
+
+                    chunk->read (&buffer, 0, numSamples, position, true, true);
+
+                    if (! writer->writeFromAudioSampleBuffer (buffer, 0, numSamples))
+                        return "write error";
+                }
+            }
+
+            writer.reset();
+
+            if (! temporary.overwriteTargetFileWithTemporary())
+                return "can't replace " + file.output.getFullPathName();
+
+            return {};
+        }
+
+        // Runs samples start to end - 1 of the input through the processor
+        // into the writer. A chunk that starts later than sample 0 is preceded
+        // by a warm-up whose output is thrown away.
+        juce::String process (juce::AudioFormatReader& reader, juce::AudioFormatWriter& writer, juce::int64 start, juce::int64 end)
+        {
+            const auto numChannels = (int) reader.numChannels;
+
+            processor.setRateAndBufferSizeDetails (reader.sampleRate, options.blockSize);
+            processor.prepareToPlay (reader.sampleRate, options.blockSize);
+
+            const auto warmUp = (juce::int64) std::ceil (processor.getSettlingTimeSeconds() * reader.sampleRate);
+            const auto from = juce::jmax ((juce::int64) 0, start - warmUp);
+
+            juce::AudioBuffer<float> buffer (numChannels, options.blockSize);
+            juce::MidiBuffer midi;
+
+            // Two passes: the gain of the whole range first, from the warm-up
+            // to the lookahead past the end, then the render that applies it
+            if (options.lookaheadMs > 0.0)
+            {
+                const auto lookahead = (int) std::ceil (options.lookaheadMs * 0.001 * reader.sampleRate);
+                const auto analysisEnd = juce::jmin (reader.lengthInSamples, end + lookahead);
+                gainCurve.reset (numChannels, analysisEnd - from);
+
+                for (auto position = from; position < analysisEnd; position += options.blockSize)
+                {
+                    if (threadShouldExit())
+                        return "cancelled";
+
+                    const auto numSamples = (int) juce::jmin ((juce::int64) options.blockSize, analysisEnd - position);
+                    buffer.setSize (numChannels, numSamples, false, false, true);
+
+                    reader.read (&buffer, 0, numSamples, position, true, true);
+
+                    processor.analyseBlock (buffer, gainCurve);
+                }
+
+                gainCurve.finish (lookahead);
+
+                // Back to the start, with fresh state
+                processor.prepareToPlay (reader.sampleRate, options.blockSize);
+                processor.setGainCurve (&gainCurve);
+            }
+
+            for (auto position = from; position < end;)
+            {
+                if (threadShouldExit())
+                    return "cancelled";
+
+                // The warm-up ends on a block boundary, so no block is half kept
+                const auto blockEnd = position < start ? start : end;
+                const auto numSamples = (int) juce::jmin ((juce::int64) options.blockSize, blockEnd - position);
+                buffer.setSize (numChannels, numSamples, false, false, true);
+
+                reader.read (&buffer, 0, numSamples, position, true, true);
+
+                processor.processBlock (buffer, midi);
+
+                if (position >= start && ! writer.writeFromAudioSampleBuffer (buffer, 0, numSamples))
+                    return "write error";
+
+                position += numSamples;
+            }
+
+            processor.setGainCurve (nullptr);
+            processor.releaseResources();
+            return {};
+        }
+
+        static void log (const juce::String& message)
+        {
+            static std::mutex lock;
+            const std::lock_guard<std::mutex> guard (lock);
+            std::cout << message << std::endl;
+        }
+
+        const Options& options;
+        const std::vector<Task>& tasks;
+        std::atomic<int>& nextTask;
+        std::atomic<int>& numFailures;
+
+        juce::AudioFormatManager formatManager;
+        SmoosherAudioProcessor processor;
+
+        // For two-pass renders; a member, so the processor never holds on to
+        // a freed one after a failed render
+        GainCurve gainCurve;
+    };
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::ArgumentList args (argc, argv);
+
+    if (args.containsOption ("--help|-h") || args.size() == 0)
+    {
+        printUsage();
+        return args.size() == 0 ? 1 : 0;
+    }
+
+    if (args.containsOption ("--list-presets"))
+    {
+        for (const auto& preset : factoryPresets)
+            std::cout << preset.name << ": smoosh " << preset.smoosh << "%, input " << preset.inputGain
+                      << " dB, output " << preset.outputGain << " dB\n";
+        return 0;
+    }
+
+    Options options;
+    auto error = parseOptions (args, options);
+
+    if (error.isNotEmpty())
+    {
+        std::cerr << error << "\n\n";
+        printUsage();
+        return 1;
+    }
+
+    // With more than one job, files longer than a chunk are split so that
+    // a few long renders still keep every worker busy
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    std::vector<std::unique_ptr<FileJob>> files;
+    std::vector<Task> tasks;
+
+    for (const auto& input : options.inputs)
+    {
+        auto file = std::make_unique<FileJob>();
+        file->input = input;
+        file->output = outputFileFor (options, input);
+
+        if (options.numJobs > 1 && options.chunkSeconds > 0.0)
+        {
+            if (std::unique_ptr<juce::AudioFormatReader> reader { formatManager.createReaderFor (input) })
+            {
+                file->chunkLength = juce::jmax ((juce::int64) 1, (juce::int64) (options.chunkSeconds * reader->sampleRate));
+                file->numChunks = (int) juce::jmax ((juce::int64) 1, (reader->lengthInSamples + file->chunkLength - 1) / file->chunkLength);
+            }
+        }
+
+        file->chunksLeft = file->numChunks;
+
+        for (int chunk = 0; chunk < file->numChunks; ++chunk)
+        {
+            if (file->numChunks > 1)
+                file->chunkFiles.push_back (std::make_unique<juce::TemporaryFile> (file->output.withFileExtension ("wav")));
+
+            tasks.push_back ({ file.get(), chunk });
+        }
+
+        files.push_back (std::move (file));
+    }
+
+    // Processors are created here on the main thread, one per worker
+    std::atomic<int> nextTask { 0 }, numFailures { 0 };
+    std::vector<std::unique_ptr<RenderWorker>> workers;
+
+    for (int i = 0; i < juce::jmin (options.numJobs, (int) tasks.size()); ++i)
+        workers.push_back (std::make_unique<RenderWorker> (options, tasks, nextTask, numFailures));
+
+    for (auto& worker : workers)
+        worker->startThread();
+
+    for (auto& worker : workers)
+        worker->waitForThreadToExit (-1);
+
+    workers.clear();
+
+    if (numFailures > 0)
+    {
+        std::cerr << numFailures.load() << " of " << options.inputs.size() << " files failed\n";
+        return 1;
+    }
+
+    return 0;
+}